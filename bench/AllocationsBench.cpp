@@ -0,0 +1,97 @@
+#include "LandingGear.h"
+#include "AllocationCounter.h"
+#include "Bench.h"
+
+#include <cstring>
+#include <sys/socket.h>
+
+namespace LG = LandingGear;
+
+// Requests of the kinds a typical application serves
+static const struct {
+  const char* name;
+  const char* request;
+} requests[] = {
+  {"static route", "GET /static/route HTTP/1.1\r\nHost: localhost\r\n\r\n"},
+  {"route with a parameter", "GET /users/42 HTTP/1.1\r\nHost: localhost\r\n\r\n"},
+  {"browser headers",
+    "GET /static/route HTTP/1.1\r\n"
+    "Host: app.example.com\r\n"
+    "Connection: keep-alive\r\n"
+    "User-Agent: Mozilla/5.0 (X11; Linux x86_64; rv:109.0) Gecko/20100101 Firefox/118.0\r\n"
+    "Accept: text/html,application/xhtml+xml,application/xml;q=0.9,*/*;q=0.8\r\n"
+    "Accept-Language: en-US,en;q=0.5\r\n"
+    "Accept-Encoding: gzip, deflate, br\r\n"
+    "Referer: https://app.example.com/\r\n"
+    "Cookie: session=8f14e45fceea167a5a36dedd4bea2543\r\n"
+    "Upgrade-Insecure-Requests: 1\r\n"
+    "Sec-Fetch-Dest: document\r\n"
+    "Sec-Fetch-Mode: navigate\r\n"
+    "Sec-Fetch-Site: same-origin\r\n"
+    "\r\n"},
+  {"json body", "POST /echo HTTP/1.1\r\nHost: localhost\r\nContent-Type: application/json\r\nContent-Length: 17\r\n\r\n{\"name\":\"widget\"}"},
+  {"response headers", "GET /headers HTTP/1.1\r\nHost: localhost\r\n\r\n"},
+};
+
+// Allocations of one connection for each of `count` requests, after a few to warm up its buffers
+static double allocationsPerRequest(LG::LandingGear& app, const char* request, size_t count) {
+  int sockets[2];
+  socketpair(AF_UNIX, SOCK_STREAM, 0, sockets);
+
+  LG::LGClientSocket socket = LG::LGClientSocket(sockets[0]);
+  socket.setNonBlocking(); // read like the event loop does, until nothing is left
+
+  LG::LGConnection connection = LG::LGConnection(socket, &app);
+  size_t length = std::strlen(request);
+  char response[4096];
+  unsigned long total = 0;
+
+  for (size_t i = 0; i < count + 3; i++) {
+    ::send(sockets[1], request, length, 0);
+
+    unsigned long before = LG::allocations.load();
+    connection.onEvent(LG::LG_POLL_READ);
+
+    if (i >= 3) {
+      total += LG::allocations.load() - before;
+    }
+
+    ::recv(sockets[1], response, sizeof(response), 0);
+  }
+
+  ::close(sockets[1]);
+
+  return (double)total / count;
+}
+
+int main() {
+  LG::LandingGear app = LG::LandingGear();
+  app.maxRequestsPerConnection = 0; // every request goes over the one connection
+
+  app.get("/static/route", [](LG::LGRequest&, LG::LGResponse& res) {
+    res.send("static");
+  });
+
+  app.get("/users/:id", [](LG::LGRequest& req, LG::LGResponse& res) {
+    res.send(req.params["id"]);
+  });
+
+  app.post("/echo", [](LG::LGRequest& req, LG::LGResponse& res) {
+    res.send(req.body());
+  });
+
+  app.get("/headers", [](LG::LGRequest&, LG::LGResponse& res) {
+    res.header("Content-Type", "application/json");
+    res.header("Cache-Control", "no-store");
+    res.header("X-Request-Id", "42");
+    res.send("{}");
+  });
+
+  std::printf("Heap allocations per request, one connection in steady state\n");
+
+  for (const auto& request : requests) {
+    std::printf("  %-44s %8.2f\n", request.name, allocationsPerRequest(app, request.request, 1000));
+  }
+
+  return 0;
+}
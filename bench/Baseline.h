@@ -0,0 +1,178 @@
+/**
+ * @file Baseline.h
+ * @author Mason Marquez (theboys619@gmail.com)
+ * @brief The string helpers and map based headers the library used before the request parser,
+ * kept unchanged so the benchmarks can compare against them.
+ * @version 0.1
+ * @date 2022-11-11
+ *
+ * @copyright Copyright (c) 2022
+ *
+ */
+
+#ifndef BASELINE_H
+#define BASELINE_H
+
+#include <algorithm>
+#include <cctype>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+namespace LGBaseline {
+
+  // trim from start (in place)
+  inline void ltrim(std::string &s) {
+      s.erase(s.begin(), std::find_if(s.begin(), s.end(), [](unsigned char ch) {
+          return !std::isspace(ch);
+      }));
+  }
+
+  // trim from end (in place)
+  inline void rtrim(std::string &s) {
+      s.erase(std::find_if(s.rbegin(), s.rend(), [](unsigned char ch) {
+          return !std::isspace(ch);
+      }).base(), s.end());
+  }
+
+  // trim from both ends (in place)
+  inline void trim(std::string &s) {
+      ltrim(s);
+      rtrim(s);
+  }
+
+  inline std::string get(std::string thisstr, size_t start, size_t amount) {
+    std::string str = "";
+
+    for (size_t i = start; i < start+amount; i++) {
+      if (i >= thisstr.size()) break;
+      str += thisstr[i];
+    }
+
+    return str;
+  }
+
+  inline void toLowerCase(std::string& data) {
+    std::transform(data.begin(), data.end(), data.begin(),
+    [](unsigned char c){ return std::tolower(c); });
+  }
+
+  inline std::vector<std::string> split(std::string thisstr, std::string sep) {
+    std::vector<std::string> splitted = {};
+    std::string current = "";
+
+    for (size_t i = 0; i < thisstr.size(); i++) {
+      std::string peeked = get(thisstr, i, sep.size());
+
+      if (peeked == sep) {
+        splitted.push_back(current);
+        current = "";
+        i += peeked.size() - 1;
+      } else {
+        current += thisstr[i];
+      }
+      
+    }
+
+    if (current.size() > 0) splitted.push_back(current);
+
+    return splitted;
+  }
+
+  inline bool endsWith(const std::string &mainStr, const std::string &toMatch)
+  {
+    if (mainStr.size() >= toMatch.size() &&
+      mainStr.compare(mainStr.size() - toMatch.size(), toMatch.size(), toMatch) == 0)
+      return true;
+    else
+      return false;
+  }
+
+  inline bool includes(const std::string &str, const std::string &toMatch) {
+    return str.find(toMatch) != std::string::npos;
+  }
+
+  // LGHeaders as it was, a map of lowercased names
+  class LGHeaders {
+    private:
+    std::unordered_map<std::string, std::string> headers;
+    std::string dataStr;
+
+    public:
+    std::string method;
+    std::string path;
+    std::string protocol;
+
+    LGHeaders() {};
+    LGHeaders(std::string dataStr): dataStr(dataStr) {};
+
+    bool hasHeader(std::string key) {
+      return headers.find(key) != headers.end();
+    }
+
+    std::string getHeader(std::string key) {
+      return headers[key];
+    }
+
+    std::string setHeader(std::string key, std::string value) {
+      return (headers[key] = value);
+    }
+
+    std::string operator[](std::string key) {
+      return headers[key];
+    }
+
+    static LGHeaders constructHeaders(std::string unformatted) {
+      std::vector<std::string> lines = split(unformatted, "\n");
+
+      LGHeaders headers = LGHeaders(unformatted);
+
+      for (size_t i = 0; i < lines.size(); i++) {
+        std::vector<std::string> headerKV = split(lines[i], ":");
+        std::string key = headerKV[0];
+        trim(key);
+
+        std::string value = "";
+
+        for (size_t j = 1; j < headerKV.size(); j++) {
+          std::string newValue = headerKV[j];
+          trim(newValue);
+
+          value += (j > 1 ? ":" : "") + newValue;
+        }
+
+        toLowerCase(key);
+
+        headers.setHeader(key, value);
+      }
+
+      return headers;
+    }
+
+    static LGHeaders constructRequestInfo(std::string unformatted) {
+      if (endsWith(unformatted, "\n")) {
+        unformatted = split(unformatted, "\n")[0];
+      }
+      std::vector<std::string> reqInfo = split(unformatted, " "); // REQUEST: METHOD, PATH, PROTOCOL
+      trim(reqInfo[0]);
+
+      std::string method = reqInfo[0];
+
+      trim(reqInfo[1]);
+      std::string path = reqInfo[1];
+
+      trim(reqInfo[2]);
+      std::string protocol = reqInfo[2];
+
+      LGHeaders headers = LGHeaders(unformatted);
+      headers.method = method;
+      headers.path = path;
+      headers.protocol = protocol;
+
+      return headers;
+    }
+  };
+
+}; // namespace LGBaseline
+
+#endif
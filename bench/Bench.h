@@ -0,0 +1,85 @@
+/**
+ * @file Bench.h
+ * @author Mason Marquez (theboys619@gmail.com)
+ * @brief Timing helpers shared by the benchmarks in bench/.
+ * @version 0.1
+ * @date 2022-11-11
+ *
+ * @copyright Copyright (c) 2022
+ *
+ */
+
+#ifndef BENCH_H
+#define BENCH_H
+
+#include <algorithm>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+
+#if (defined(__x86_64__) || defined(__i386__)) && (defined(__GNUC__) || defined(__clang__))
+#define LG_BENCH_CYCLES
+#include <x86intrin.h>
+#endif
+
+namespace LandingGear {
+
+  // Cycles where the CPU has a time stamp counter, nanoseconds elsewhere
+  inline uint64_t benchTicks() {
+#ifdef LG_BENCH_CYCLES
+    return __rdtsc();
+#else
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now().time_since_epoch()).count();
+#endif
+  }
+
+  // The unit of benchTicks, `plural` for counts like "cycles/op"
+  inline const char* benchTickUnit(bool plural = false) {
+#ifdef LG_BENCH_CYCLES
+    return plural ? "cycles" : "cycle";
+#else
+    return "ns";
+#endif
+  }
+
+  // Keeps the compiler from dropping a result that is never used
+  template <typename T>
+  inline void benchKeep(const T& value) {
+    asm volatile("" : : "g"(&value) : "memory");
+  }
+
+  /**
+   * @brief Runs `run` `iterations` times per round and returns the ticks per iteration of the fastest round.
+   *
+   */
+  template <typename F>
+  double benchMeasure(size_t iterations, F&& run) {
+    double best = 0;
+
+    for (int round = 0; round < 5; round++) {
+      uint64_t start = benchTicks();
+
+      for (size_t i = 0; i < iterations; i++) {
+        run();
+      }
+
+      double ticks = (double)(benchTicks() - start) / iterations;
+      best = round == 0 ? ticks : std::min(best, ticks);
+    }
+
+    return best;
+  }
+
+  // Prints one line of results, `bytes` is the input handled per iteration (0 to leave out the throughput)
+  inline void benchReport(const char* name, double ticks, size_t bytes = 0) {
+    if (bytes > 0) {
+      std::printf("  %-44s %12.1f %s/op %8.3f bytes/%s\n", name, ticks, benchTickUnit(true), bytes / ticks, benchTickUnit());
+    } else {
+      std::printf("  %-44s %12.1f %s/op\n", name, ticks, benchTickUnit(true));
+    }
+  }
+
+}; // namespace LandingGear
+
+#endif
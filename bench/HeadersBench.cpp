@@ -0,0 +1,114 @@
+#include "LandingGear.h"
+#include "Bench.h"
+#include "Baseline.h"
+
+#include <memory_resource>
+
+namespace LG = LandingGear;
+
+// Headers of a browser request, the first `count` are used
+static const LG::LGHeaderView browserHeaders[] = {
+  {"Host", "app.example.com"},
+  {"Connection", "keep-alive"},
+  {"User-Agent", "Mozilla/5.0 (X11; Linux x86_64; rv:109.0) Gecko/20100101 Firefox/118.0"},
+  {"Accept", "text/html,application/xhtml+xml,application/xml;q=0.9,*/*;q=0.8"},
+  {"Accept-Language", "en-US,en;q=0.5"},
+  {"Accept-Encoding", "gzip, deflate, br"},
+  {"Referer", "https://app.example.com/"},
+  {"Cookie", "session=8f14e45fceea167a5a36dedd4bea2543"},
+  {"Upgrade-Insecure-Requests", "1"},
+  {"Cache-Control", "max-age=0"},
+  {"Sec-Fetch-Dest", "document"},
+  {"Sec-Fetch-Mode", "navigate"},
+  {"Sec-Fetch-Site", "same-origin"},
+  {"Sec-Fetch-User", "?1"},
+  {"If-None-Match", "\"5e1f-18b2a3c4d5e\""},
+  {"If-Modified-Since", "Tue, 10 Oct 2023 08:49:37 GMT"},
+  {"DNT", "1"},
+  {"Origin", "https://app.example.com"},
+  {"Pragma", "no-cache"},
+  {"TE", "trailers"},
+};
+
+// What the library looks up for every request, plus one header an application might
+static const char* lookups[] = {"host", "connection", "content-length", "transfer-encoding", "expect", "accept-encoding", "x-request-id"};
+
+static void runBaseline(size_t count) {
+  LGBaseline::LGHeaders headers;
+
+  for (size_t i = 0; i < count; i++) {
+    std::string key = std::string(browserHeaders[i].name);
+    LGBaseline::toLowerCase(key);
+    headers.setHeader(key, std::string(browserHeaders[i].value));
+  }
+
+  for (const char* name : lookups) {
+    LG::benchKeep(headers.getHeader(name)); // inserts the missing ones, as it did
+  }
+}
+
+static void runCurrent(size_t count) {
+  char arena[2048];
+  std::pmr::monotonic_buffer_resource resource(arena, sizeof(arena));
+  LG::LGHeaders headers = LG::LGHeaders(&resource);
+
+  for (size_t i = 0; i < count; i++) {
+    headers.addHeaderView(browserHeaders[i].name, browserHeaders[i].value);
+  }
+
+  for (const char* name : lookups) {
+    LG::benchKeep(headers.getHeader(name));
+  }
+}
+
+// The library's own lookups go by id, without hashing the name
+static void runCurrentById(size_t count) {
+  static const LG::LGHeaderId ids[] = {
+    LG::LGHeaderId::HOST, LG::LGHeaderId::CONNECTION, LG::LGHeaderId::CONTENT_LENGTH, LG::LGHeaderId::TRANSFER_ENCODING,
+    LG::LGHeaderId::EXPECT, LG::LGHeaderId::ACCEPT_ENCODING,
+  };
+
+  char arena[2048];
+  std::pmr::monotonic_buffer_resource resource(arena, sizeof(arena));
+  LG::LGHeaders headers = LG::LGHeaders(&resource);
+
+  for (size_t i = 0; i < count; i++) {
+    headers.addHeaderView(browserHeaders[i].name, browserHeaders[i].value);
+  }
+
+  for (LG::LGHeaderId id : ids) {
+    LG::benchKeep(headers.getHeader(id));
+  }
+
+  LG::benchKeep(headers.getHeader("x-request-id"));
+}
+
+int main() {
+  std::printf("Storing a request's headers and looking up %zu names\n", sizeof(lookups) / sizeof(lookups[0]));
+
+  for (size_t count : {10, 15, 20}) {
+    std::printf("%zu headers\n", count);
+
+    LG::benchReport("unordered_map, lowercased names", LG::benchMeasure(20000, [&]() { runBaseline(count); }));
+    LG::benchReport("LGHeaders, by name", LG::benchMeasure(20000, [&]() { runCurrent(count); }));
+    LG::benchReport("LGHeaders, well-known by id", LG::benchMeasure(20000, [&]() { runCurrentById(count); }));
+  }
+
+  // Lookups alone, on headers stored once
+  LGBaseline::LGHeaders mapHeaders;
+  LG::LGHeaders flatHeaders;
+
+  for (const LG::LGHeaderView& header : browserHeaders) {
+    std::string key = std::string(header.name);
+    LGBaseline::toLowerCase(key);
+    mapHeaders.setHeader(key, std::string(header.value));
+    flatHeaders.addHeader(header.name, header.value);
+  }
+
+  std::printf("one lookup of Accept-Encoding in 20 headers\n");
+  LG::benchReport("unordered_map", LG::benchMeasure(100000, [&]() { LG::benchKeep(mapHeaders.getHeader("accept-encoding")); }));
+  LG::benchReport("LGHeaders, by name", LG::benchMeasure(100000, [&]() { LG::benchKeep(flatHeaders.getHeader("Accept-Encoding")); }));
+  LG::benchReport("LGHeaders, by id", LG::benchMeasure(100000, [&]() { LG::benchKeep(flatHeaders.getHeader(LG::LGHeaderId::ACCEPT_ENCODING)); }));
+
+  return 0;
+}
@@ -0,0 +1,124 @@
+#include "LandingGear.h"
+#include "RequestParser.h"
+#include "Scan.h"
+#include "Bench.h"
+#include "Baseline.h"
+
+#include <memory_resource>
+
+namespace LG = LandingGear;
+
+// Request heads as browsers and tools send them
+static const struct {
+  const char* name;
+  const char* head;
+} requests[] = {
+  {"curl",
+    "GET /api/items?page=2 HTTP/1.1\r\n"
+    "Host: localhost:8080\r\n"
+    "User-Agent: curl/7.88.1\r\n"
+    "Accept: */*\r\n"
+    "\r\n"},
+  {"chrome navigation",
+    "GET /dashboard/projects/42?tab=activity HTTP/1.1\r\n"
+    "Host: app.example.com\r\n"
+    "Connection: keep-alive\r\n"
+    "Cache-Control: max-age=0\r\n"
+    "sec-ch-ua: \"Chromium\";v=\"118\", \"Google Chrome\";v=\"118\", \"Not=A?Brand\";v=\"99\"\r\n"
+    "sec-ch-ua-mobile: ?0\r\n"
+    "sec-ch-ua-platform: \"Windows\"\r\n"
+    "Upgrade-Insecure-Requests: 1\r\n"
+    "User-Agent: Mozilla/5.0 (Windows NT 10.0; Win64; x64) AppleWebKit/537.36 (KHTML, like Gecko) Chrome/118.0.0.0 Safari/537.36\r\n"
+    "Accept: text/html,application/xhtml+xml,application/xml;q=0.9,image/avif,image/webp,image/apng,*/*;q=0.8,application/signed-exchange;v=b3;q=0.7\r\n"
+    "Sec-Fetch-Site: same-origin\r\n"
+    "Sec-Fetch-Mode: navigate\r\n"
+    "Sec-Fetch-User: ?1\r\n"
+    "Sec-Fetch-Dest: document\r\n"
+    "Referer: https://app.example.com/dashboard\r\n"
+    "Accept-Encoding: gzip, deflate, br\r\n"
+    "Accept-Language: en-US,en;q=0.9,de;q=0.8\r\n"
+    "Cookie: session=8f14e45fceea167a5a36dedd4bea2543; theme=dark; _ga=GA1.1.1234567890.1697000000\r\n"
+    "\r\n"},
+  {"firefox fetch",
+    "POST /api/comments HTTP/1.1\r\n"
+    "Host: app.example.com\r\n"
+    "User-Agent: Mozilla/5.0 (X11; Linux x86_64; rv:109.0) Gecko/20100101 Firefox/118.0\r\n"
+    "Accept: application/json\r\n"
+    "Accept-Language: en-US,en;q=0.5\r\n"
+    "Accept-Encoding: gzip, deflate, br\r\n"
+    "Referer: https://app.example.com/posts/17\r\n"
+    "Content-Type: application/json\r\n"
+    "Content-Length: 42\r\n"
+    "Origin: https://app.example.com\r\n"
+    "Connection: keep-alive\r\n"
+    "Cookie: session=8f14e45fceea167a5a36dedd4bea2543\r\n"
+    "Sec-Fetch-Dest: empty\r\n"
+    "Sec-Fetch-Mode: cors\r\n"
+    "Sec-Fetch-Site: same-origin\r\n"
+    "\r\n"},
+  {"safari asset",
+    "GET /static/js/main.4f2a9c1e.js HTTP/1.1\r\n"
+    "Host: app.example.com\r\n"
+    "Accept: */*\r\n"
+    "Connection: keep-alive\r\n"
+    "If-None-Match: \"5e1f-18b2a3c4d5e\"\r\n"
+    "If-Modified-Since: Tue, 10 Oct 2023 08:49:37 GMT\r\n"
+    "User-Agent: Mozilla/5.0 (Macintosh; Intel Mac OS X 10_15_7) AppleWebKit/605.1.15 (KHTML, like Gecko) Version/17.0 Safari/605.1.15\r\n"
+    "Accept-Language: en-GB,en;q=0.9\r\n"
+    "Referer: https://app.example.com/\r\n"
+    "Accept-Encoding: gzip, deflate, br\r\n"
+    "\r\n"},
+};
+
+// What `getRequest` did with a received head before the parser
+static void parseBaseline(const std::string& data) {
+  size_t headerStartIndex = data.find("\r\n");
+  LGBaseline::LGHeaders reqInfo = LGBaseline::LGHeaders::constructRequestInfo(data.substr(0, headerStartIndex));
+
+  size_t endingIndex = data.find("\r\n\r\n");
+  std::string headersString = data.substr(headerStartIndex, endingIndex - headerStartIndex);
+  LGBaseline::trim(headersString);
+
+  LGBaseline::LGHeaders headers = LGBaseline::LGHeaders::constructHeaders(headersString);
+  headers.method = reqInfo.method;
+  headers.path = reqInfo.path;
+  headers.protocol = reqInfo.protocol;
+
+  LG::benchKeep(headers);
+}
+
+// What a connection does now, parsing in place and keeping the headers as views
+static void parseCurrent(LG::LGRequestParser& parser, const std::string& data) {
+  char arena[4096];
+  std::pmr::monotonic_buffer_resource resource(arena, sizeof(arena));
+
+  parser.reset();
+  parser.parse(data.data(), data.size());
+
+  LG::LGHeaders headers = LG::LGHeaders(&resource);
+  headers.method = parser.method;
+  headers.path = parser.path;
+  headers.protocol = parser.protocol;
+
+  for (const LG::LGHeaderView& header : parser.headers) {
+    headers.addHeaderView(header.name, header.value);
+  }
+
+  LG::benchKeep(headers);
+}
+
+int main() {
+  LG::LGRequestParser parser;
+
+  std::printf("Request head parsing (scanning with %s)\n", LG::scanImplementation());
+
+  for (const auto& request : requests) {
+    std::string data = request.head;
+    std::printf("%s, %zu bytes\n", request.name, data.size());
+
+    LG::benchReport("split/constructHeaders", LG::benchMeasure(2000, [&]() { parseBaseline(data); }), data.size());
+    LG::benchReport("LGRequestParser", LG::benchMeasure(2000, [&]() { parseCurrent(parser, data); }), data.size());
+  }
+
+  return 0;
+}
@@ -0,0 +1,128 @@
+#include "Scan.h"
+#include "Bench.h"
+#include "Baseline.h"
+
+#include <cstring>
+#include <string>
+
+namespace LG = LandingGear;
+
+// A head of 20 headers, the shape the parser scans for every request
+static std::string makeHead() {
+  std::string head = "GET /dashboard/projects/42?tab=activity HTTP/1.1\r\n";
+
+  for (int i = 0; i < 20; i++) {
+    head += "X-Header-" + std::to_string(i) + ":   value number " + std::to_string(i) + " with some padding text  \r\n";
+  }
+
+  return head + "\r\n";
+}
+
+// Lines and header values found the way `getRequest` and `constructHeaders` did
+static void scanBaseline(const std::string& head) {
+  size_t lines = 0;
+
+  for (std::string line : LGBaseline::split(head, "\r\n")) {
+    std::vector<std::string> parts = LGBaseline::split(line, ":");
+
+    if (parts.size() > 1) {
+      LGBaseline::trim(parts[1]);
+    }
+
+    lines++;
+  }
+
+  LG::benchKeep(lines);
+  LG::benchKeep(LGBaseline::includes(head, "\r\n\r\n"));
+}
+
+// The same with std::string::find, what the string helpers could do at best without the copies
+static void scanFind(const std::string& head) {
+  size_t lines = 0;
+  size_t start = 0;
+
+  while (true) {
+    size_t end = head.find("\r\n", start);
+
+    if (end == std::string::npos || end == start) {
+      break;
+    }
+
+    size_t colon = head.find(':', start);
+
+    if (colon < end) {
+      size_t value = head.find_first_not_of(" \t", colon + 1);
+      LG::benchKeep(value);
+    }
+
+    lines++;
+    start = end + 2;
+  }
+
+  LG::benchKeep(lines);
+}
+
+// The same with the scanning kernels, as the request parser does it
+static void scanKernels(const std::string& head) {
+  const char* p = head.data();
+  const char* end = p + head.size();
+  size_t lines = 0;
+
+  while (true) {
+    const char* lineEnd = LG::scanFor(p, end, '\n');
+
+    if (lineEnd == end || lineEnd - p <= 1) {
+      break;
+    }
+
+    const char* colon = LG::scanFor(p, lineEnd, ':');
+
+    if (colon < lineEnd) {
+      LG::benchKeep(LG::skipBlanks(colon + 1, lineEnd));
+    }
+
+    lines++;
+    p = lineEnd + 1;
+  }
+
+  LG::benchKeep(lines);
+}
+
+static const char* scanLoop(const char* p, const char* end, char c) {
+  while (p < end && *p != c) p++;
+  return p;
+}
+
+int main() {
+  std::printf("Byte scanning (kernels: %s)\n", LG::scanImplementation());
+
+  std::string head = makeHead();
+  std::printf("request head, %zu bytes, 21 lines\n", head.size());
+
+  LG::benchReport("split/trim/includes", LG::benchMeasure(200, [&]() { scanBaseline(head); }), head.size());
+  LG::benchReport("std::string::find", LG::benchMeasure(20000, [&]() { scanFind(head); }), head.size());
+  LG::benchReport("scanFor/skipBlanks", LG::benchMeasure(20000, [&]() { scanKernels(head); }), head.size());
+
+  // A long line, eg. a large cookie, shows the raw speed of each search
+  for (size_t size : {64, 1024, 16 * 1024}) {
+    std::string line(size, 'a');
+    line.back() = '\n';
+
+    const char* begin = line.data();
+    const char* end = begin + line.size();
+
+    std::printf("looking for the end of a %zu byte line\n", size);
+    LG::benchReport("byte loop", LG::benchMeasure(20000, [&]() { LG::benchKeep(scanLoop(begin, end, '\n')); }), size);
+    LG::benchReport("std::string::find", LG::benchMeasure(20000, [&]() { LG::benchKeep(line.find("\r\n")); }), size);
+    LG::benchReport("memchr", LG::benchMeasure(20000, [&]() { LG::benchKeep(std::memchr(begin, '\n', size)); }), size);
+    LG::benchReport("scanFor", LG::benchMeasure(20000, [&]() { LG::benchKeep(LG::scanFor(begin, end, '\n')); }), size);
+
+    std::string blanks(size, ' ');
+    blanks.back() = 'x';
+
+    LG::benchReport("trim", LG::benchMeasure(2000, [&]() { std::string copy = blanks; LGBaseline::ltrim(copy); LG::benchKeep(copy); }), size);
+    LG::benchReport("skipBlanks", LG::benchMeasure(20000, [&]() { LG::benchKeep(LG::skipBlanks(blanks.data(), blanks.data() + size)); }), size);
+  }
+
+  return 0;
+}
@@ -0,0 +1,128 @@
+#include "LandingGear.h"
+#include "Bench.h"
+
+#include <fstream>
+#include <sys/socket.h>
+#include <sys/stat.h>
+
+namespace LG = LandingGear;
+
+static const std::string folder = "bench/bin/files";
+
+static void writeFile(const std::string& name, size_t size) {
+  std::ofstream file(folder + "/" + name, std::ios::binary);
+  std::string line(79, 'x');
+
+  for (size_t written = 0; written < size; written += 80) {
+    file << line << '\n';
+  }
+}
+
+// The old `getStatic`, reading the file line by line into the response
+static LG::LGMiddlewareCB getStaticIfstream(std::string folderpath) {
+  return [folderpath](LG::LGRequest& req, LG::LGResponse& res, LG::NextFunction next) {
+    std::string_view path = req.path;
+    std::string realPath = std::string(path.substr(path.find(folderpath) + folderpath.size() + 1));
+    std::ifstream File(folderpath + "/" + realPath);
+
+    if (!File.good()) {
+      next();
+      return;
+    }
+
+    std::string line;
+    std::string data = "";
+    while (std::getline(File, line)) {
+      data += line;
+    }
+
+    res.send(data);
+  };
+}
+
+// Sends a request and reads the whole response, returns the size of the body
+static size_t fetch(int socket, const std::string& request) {
+  ::send(socket, request.data(), request.size(), 0);
+
+  static char buffer[256 * 1024];
+  std::string head;
+  size_t received = 0;
+
+  while (head.find("\r\n\r\n") == std::string::npos) {
+    ssize_t bytes = ::recv(socket, buffer, sizeof(buffer), 0);
+    if (bytes <= 0) return 0;
+    head.append(buffer, bytes);
+  }
+
+  size_t bodyStart = head.find("\r\n\r\n") + 4;
+  size_t length = std::stoul(head.substr(head.find("Content-Length: ") + 16));
+  received = head.size() - bodyStart;
+
+  while (received < length) {
+    ssize_t bytes = ::recv(socket, buffer, sizeof(buffer), 0);
+    if (bytes <= 0) return 0;
+    received += bytes;
+  }
+
+  return length;
+}
+
+int main() {
+  mkdir("bench/bin", 0755);
+  mkdir(folder.c_str(), 0755);
+
+  const struct {
+    const char* name;
+    size_t size;
+    size_t iterations;
+  } files[] = {
+    {"small", 2 * 1024, 2000},
+    {"medium", 128 * 1024, 300},
+    {"large", 16 * 1024 * 1024, 5},
+  };
+
+  for (const auto& file : files) {
+    writeFile(file.name, file.size);
+  }
+
+  LG::LGStaticOptions readOptions;
+  readOptions.memoryBudget = 0; // every response from the open file
+
+  LG::LGStaticOptions mapOptions = readOptions;
+  mapOptions.memoryMap = true;
+
+  LG::LandingGear app = LG::LandingGear();
+  app.maxRequestsPerConnection = 0; // every request goes over the one connection
+  app.use("/ifstream", getStaticIfstream(folder));
+  app.use("/read", LG::getStatic(folder, readOptions));
+  app.use("/mmap", LG::getStatic(folder, mapOptions));
+  app.use("/cached", LG::getStatic(folder)); // small files are kept in memory as prepared responses
+
+  int sockets[2];
+  socketpair(AF_UNIX, SOCK_STREAM, 0, sockets);
+
+  std::thread server([&app, &sockets]() {
+    LG::LGConnection connection = LG::LGConnection(LG::LGClientSocket(sockets[0]), &app);
+    connection.run();
+  });
+
+  std::printf("Static files over a unix socket, the throughput counts the body only\n");
+
+  for (const auto& file : files) {
+    std::printf("%s file, %zu bytes\n", file.name, file.size);
+
+    for (const char* backend : {"ifstream", "read", "mmap", "cached"}) {
+      std::string request = std::string("GET /") + backend + "/" + folder + "/" + file.name + " HTTP/1.1\r\nHost: localhost\r\n\r\n";
+      size_t length = fetch(sockets[1], request);
+
+      double ticks = LG::benchMeasure(file.iterations, [&]() { fetch(sockets[1], request); });
+      LG::benchReport(backend, ticks, length);
+    }
+  }
+
+  ::shutdown(sockets[1], SHUT_WR);
+  server.join();
+  ::close(sockets[1]);
+
+  return 0;
+}
@@ -0,0 +1,74 @@
+/**
+ * @file BodyReader.h
+ * @author Mason Marquez (theboys619@gmail.com)
+ * @brief An incremental request body decoder for Content-Length and chunked bodies.
+ * @version 0.1
+ * @date 2022-11-11
+ *
+ * @copyright Copyright (c) 2022
+ *
+ */
+
+#ifndef BODYREADER_H
+#define BODYREADER_H
+
+#include <cstddef>
+#include <cstdint>
+#include <string_view>
+#include <vector>
+
+namespace LandingGear {
+
+  /**
+   * @brief Result of feeding data to the body reader.
+   *
+   */
+  enum class LGBodyResult {
+    INCOMPLETE, // more data is needed
+    COMPLETE, // the whole body has been read
+    ERROR, // the body is malformed, see `errorCode`
+  };
+
+  /**
+   * @brief Decodes the body of one request. Data is consumed as it is decoded, so the caller
+   * drops `consumed` bytes from its buffer after every call. Decoded data is handed out as views
+   * into the buffer, chunked framing is never copied.
+   *
+   */
+  class LGBodyReader {
+    private:
+    enum class State {
+      LENGTH, // reading a Content-Length body
+      CHUNK_SIZE, // waiting for a chunk size line
+      CHUNK_DATA, // reading chunk data
+      CHUNK_DATA_END, // waiting for the line break after chunk data
+      TRAILERS, // skipping trailer fields after the last chunk
+      DONE,
+    };
+
+    State state;
+    uint64_t remaining; // bytes left of the body or of the current chunk
+
+    LGBodyResult fail(int code);
+    bool parseChunkSize(const char* line, const char* lineEnd);
+
+    public:
+    size_t maxLineLength; // longer chunk size or trailer lines fail with 400
+
+    int errorCode; // the status code to answer with after an ERROR
+    size_t consumed; // bytes of the data used by the last call
+    std::vector<std::string_view> chunks; // body data decoded by the last call, views into its data
+
+    LGBodyReader();
+
+    void reset();
+    void expectLength(uint64_t length);
+    void expectChunked();
+
+    bool done() const;
+    LGBodyResult decode(const char* data, size_t size);
+  };
+
+}; // namespace LandingGear
+
+#endif
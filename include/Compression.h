@@ -0,0 +1,47 @@
+/**
+ * @file Compression.h
+ * @author Mason Marquez (theboys619@gmail.com)
+ * @brief Compressing response bodies with gzip or deflate for clients that accept it.
+ * @version 0.1
+ * @date 2022-11-11
+ *
+ * @copyright Copyright (c) 2022
+ *
+ */
+
+#ifndef COMPRESSION_H
+#define COMPRESSION_H
+
+#include <cstddef>
+#include <memory>
+#include <string>
+#include <string_view>
+
+#include "WorkerPool.h"
+
+namespace LandingGear {
+
+  /**
+   * @brief Settings for `compress`.
+   *
+   */
+  struct LGCompressionOptions {
+    int level = 6; // zlib level, 1 is the fastest and 9 the smallest
+    size_t threshold = 1024; // smaller bodies are sent as they are
+    size_t offloadSize = 64 * 1024; // bodies at least this large are compressed on `pool` when the server runs event loops. 0 never offloads
+    unsigned int threads = 2; // size of the pool created when `pool` is null. 0 uses the hardware concurrency
+    std::shared_ptr<LGWorkerPool> pool; // created from `threads` when null, once the first body is offloaded
+  };
+
+  // Content encodings `compress` produces.
+  enum class LGCompression {
+    NONE,
+    GZIP,
+    DEFLATE,
+  };
+
+  std::string compressBody(std::string_view body, LGCompression encoding, int level);
+
+}; // namespace LandingGear
+
+#endif
@@ -62,6 +62,7 @@ namespace LandingGear {
     void addEvent(std::string event);
 
     void emit(std::string event, EventData data);
+    size_t listenerCount(const std::string& event) const;
 
     void off(std::string event, EventCallback cb);
     void once(std::string event, EventCallback cb);
@@ -0,0 +1,91 @@
+/**
+ * @file EventLoop.h
+ * @author Mason Marquez (theboys619@gmail.com)
+ * @brief A readiness based event loop. Uses edge-triggered epoll, only available on Linux.
+ * @version 0.1
+ * @date 2022-11-11
+ *
+ * @copyright Copyright (c) 2022
+ *
+ */
+
+#ifndef EVENTLOOP_H
+#define EVENTLOOP_H
+
+#if defined(__linux__)
+#define LG_HAS_EPOLL
+#endif
+
+#include <functional>
+#include <mutex>
+#include <vector>
+
+#include "TimerWheel.h"
+
+namespace LandingGear {
+
+  /**
+   * @brief Readiness flags passed to `LGPollable::onEvent`.
+   *
+   */
+  enum LGPollEvent {
+    LG_POLL_READ = 1,
+    LG_POLL_WRITE = 2,
+    LG_POLL_HANGUP = 4,
+  };
+
+  /**
+   * @brief Anything that can be registered on an event loop.
+   *
+   */
+  class LGPollable {
+    public:
+    virtual ~LGPollable() {};
+
+    // Called with a mask of LGPollEvent flags. The object may delete itself from here.
+    virtual void onEvent(int events) = 0;
+  };
+
+#ifdef LG_HAS_EPOLL
+
+  /**
+   * @brief One epoll instance driven by a single thread. Other threads may only call `post` and `stop`.
+   *
+   */
+  class LGEventLoop {
+    private:
+    int epollFd;
+    int wakeFd; // eventfd used to interrupt epoll_wait for posted jobs
+    bool running;
+
+    std::mutex postLock;
+    std::vector<std::function<void(void)>> posted;
+
+    LGTimerWheel timers;
+
+    void runPosted();
+
+    public:
+    LGEventLoop();
+    ~LGEventLoop();
+
+    LGEventLoop(const LGEventLoop&) = delete;
+    LGEventLoop& operator=(const LGEventLoop&) = delete;
+
+    int init();
+
+    int add(int fd, LGPollable* pollable, int events = LG_POLL_READ | LG_POLL_WRITE);
+    int remove(int fd);
+
+    void post(std::function<void(void)> job);
+    void schedule(LGTimer& timer, int milliseconds);
+
+    void run();
+    void stop();
+  };
+
+#endif
+
+}; // namespace LandingGear
+
+#endif
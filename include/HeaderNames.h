@@ -0,0 +1,73 @@
+/**
+ * @file HeaderNames.h
+ * @author Mason Marquez (theboys619@gmail.com)
+ * @brief Well-known HTTP header names, looked up with a perfect hash so common headers are found by index.
+ * @version 0.1
+ * @date 2022-11-11
+ *
+ * @copyright Copyright (c) 2022
+ *
+ */
+
+#ifndef HEADERNAMES_H
+#define HEADERNAMES_H
+
+#include <cstddef>
+#include <string_view>
+
+namespace LandingGear {
+
+  /**
+   * @brief The headers the library and most applications look at.
+   *
+   */
+  enum class LGHeaderId {
+    HOST,
+    CONNECTION,
+    CONTENT_LENGTH,
+    CONTENT_TYPE,
+    TRANSFER_ENCODING,
+    ACCEPT,
+    ACCEPT_ENCODING,
+    ACCEPT_LANGUAGE,
+    USER_AGENT,
+    COOKIE,
+    SET_COOKIE,
+    AUTHORIZATION,
+    CACHE_CONTROL,
+    ETAG,
+    LAST_MODIFIED,
+    IF_NONE_MATCH,
+    IF_MODIFIED_SINCE,
+    IF_RANGE,
+    RANGE,
+    EXPECT,
+    UPGRADE,
+    ORIGIN,
+    REFERER,
+    VARY,
+    CONTENT_ENCODING,
+    CONTENT_RANGE,
+    ACCEPT_RANGES,
+    LOCATION,
+    DATE,
+    KEEP_ALIVE,
+    ALLOW,
+    X_FORWARDED_FOR,
+    CONTENT_DISPOSITION,
+    SERVER,
+    TE,
+    TRAILER,
+    UNKNOWN, // any other name, also the amount of known headers
+  };
+
+  static const size_t LG_HEADER_COUNT = (size_t)LGHeaderId::UNKNOWN;
+
+  LGHeaderId headerId(std::string_view name);
+  std::string_view headerName(LGHeaderId id);
+
+  bool equalsIgnoreCase(std::string_view a, std::string_view b);
+
+}; // namespace LandingGear
+
+#endif
@@ -0,0 +1,40 @@
+/**
+ * @file HttpDate.h
+ * @author Mason Marquez (theboys619@gmail.com)
+ * @brief Formatting and parsing of HTTP dates (eg. "Sun, 06 Nov 1994 08:49:37 GMT").
+ * @version 0.1
+ * @date 2022-11-11
+ *
+ * @copyright Copyright (c) 2022
+ *
+ */
+
+#ifndef HTTPDATE_H
+#define HTTPDATE_H
+
+#include <cstdint>
+#include <string>
+#include <string_view>
+
+namespace LandingGear {
+
+  /**
+   * @brief Formats seconds since the epoch as an IMF-fixdate.
+   *
+   * @return std::string The date (eg. "Sun, 06 Nov 1994 08:49:37 GMT")
+   */
+  std::string formatHttpDate(int64_t seconds);
+
+  /**
+   * @brief Parses an IMF-fixdate, the format every current client sends.
+   *
+   * @param text The date (eg. "Sun, 06 Nov 1994 08:49:37 GMT")
+   * @param seconds Set to the seconds since the epoch
+   * @return true - The date is valid
+   * @return false - The date is malformed or in an obsolete format
+   */
+  bool parseHttpDate(std::string_view text, int64_t& seconds);
+
+}; // namespace LandingGear
+
+#endif
@@ -19,98 +19,362 @@
 #endif
 
 #include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdio>
 #include <ctime>
+#include <deque>
 #include <iomanip>
 #include <iostream>
+#include <memory_resource>
+#include <mutex>
+#include <new>
 #include <sstream>
 #include <string>
 #include <unordered_map>
 #include <vector>
 #include <cctype>
 #include <thread>
+#include <type_traits>
 #include <fstream>
 
+#include "BodyReader.h"
+#include "Compression.h"
 #include "EventListener.h"
+#include "EventLoop.h"
+#include "HeaderNames.h"
+#include "RequestParser.h"
+#include "Router.h"
+#include "StaticFiles.h"
+#include "Task.h"
+#include "WorkerPool.h"
 
 namespace LandingGear {
 
   class LandingGear;
+  class LGConnection;
+  class LGEventLoop;
+  class LGRequest;
+  class LGResponse;
+
+  // Middleware Function Types
+  typedef std::function<void(void)> NextFunction;
+  typedef std::function<void(LGRequest&, LGResponse&, NextFunction)> LGMiddlewareCB; // eg: (req, res, next) -> {}
+  typedef std::function<void(LGRequest&, LGResponse&)> ReqCallback; // eg: (req, res) -> {}
+
+#ifdef LG_HAS_COROUTINES
+  typedef std::function<LGTask(LGRequest&, LGResponse&, LGNext)> LGAsyncMiddlewareCB; // eg: (req, res, next) -> LGTask { co_await next(); }
+  typedef std::function<LGTask(LGRequest&, LGResponse&)> LGAsyncReqCallback; // eg: (req, res) -> LGTask { co_await res.write("..."); }
+#endif
+
+  // Strings by name, eg. params. Allocated from the connection's arena for requests and responses
+  typedef std::pmr::unordered_map<std::pmr::string, std::pmr::string> LGStringMap;
+
+  /**
+   * @brief One header as it was received or set. Names keep their casing.
+   * 
+   */
+  struct LGHeaderField {
+    std::string_view name;
+    std::string_view value;
+    LGHeaderId id; // UNKNOWN for names that aren't well-known
+  };
 
   /**
    * @brief Has easy implementation and use for accessing and setting HTTP headers.
+   * Headers are kept in order as views, names compare case-insensitively and well-known
+   * headers (see LGHeaderId) are found by index instead of by name.
    * 
    */
   class LGHeaders {
     private:
     std::string dataStr;
+    std::pmr::vector<LGHeaderField> fields;
+    uint32_t known[LG_HEADER_COUNT]; // position + 1 of the first field with each well-known name, 0 when it isn't set
+
+    std::pmr::memory_resource* resource; // where names and values are copied to, eg. a connection's arena
+    std::unique_ptr<std::pmr::monotonic_buffer_resource> ownedText; // used when no resource was given
+
+    std::string_view store(std::string_view text);
+    size_t find(LGHeaderId id, std::string_view name) const;
+    void copyFrom(const LGHeaders& oHeaders);
+    void reindex();
 
     public:
-    std::unordered_map<std::string, std::string> headers;
-    std::string method;
-    std::string path;
-    std::string protocol;
+    std::pmr::string method;
+    std::pmr::string path;
+    std::pmr::string protocol;
 
     LGHeaders();
+    LGHeaders(std::pmr::memory_resource* resource); // everything is allocated from `resource`, eg. a connection's arena
     LGHeaders(std::string dataStr);
     LGHeaders(std::unordered_map<std::string, std::string> headers);
-    LGHeaders(const LGHeaders& oHeaders); // copy constructor
+    LGHeaders(const LGHeaders& oHeaders); // copy constructor, copies the text
+    LGHeaders(LGHeaders&& oHeaders);
+
+    LGHeaders& operator=(const LGHeaders& oHeaders);
+    LGHeaders& operator=(LGHeaders&& oHeaders);
 
     std::string getDataStr() const;
 
-    bool hasHeader(std::string key);
+    bool hasHeader(std::string_view key) const;
+    bool hasHeader(LGHeaderId id) const;
 
-    std::string getHeader(std::string key);
-    std::string setHeader(std::string key, std::string value);
+    std::string_view getHeader(std::string_view key) const;
+    std::string_view getHeader(LGHeaderId id) const;
+    std::string_view setHeader(std::string_view key, std::string_view value);
+    std::string_view addHeader(std::string_view key, std::string_view value);
+    void addHeaderView(std::string_view key, std::string_view value); // the text must outlive the headers
+    void removeHeader(std::string_view key);
 
-    std::string operator[] (std::string key);
+    std::string_view operator[] (std::string_view key) const;
+    std::string_view operator[] (LGHeaderId id) const;
+
+    size_t size() const;
+    bool empty() const;
+    std::pmr::vector<LGHeaderField>::const_iterator begin() const;
+    std::pmr::vector<LGHeaderField>::const_iterator end() const;
 
     static LGHeaders constructHeaders(std::string unformatted);
     static LGHeaders constructHeader(std::string unformatted);
     static LGHeaders constructRequestInfo(std::string unformatted);
   };
 
+  /**
+   * @brief Progress of a request being read from a connection.
+   * 
+   */
+  enum class LGRequestState {
+    HEADERS, // waiting for the request line and headers
+    BODY, // reading the request body
+    WAITING, // the body is in, middleware that continues asynchronously hasn't finished yet
+    FINISHED, // a response has been produced
+  };
+
+  /**
+   * @brief The limit a connection is held to while it waits on the client.
+   * 
+   */
+  enum class LGTimeout {
+    NONE, // the application is busy with the request
+    IDLE, // between requests, see `keepAliveTimeout`
+    HEADERS, // receiving a request line and headers, see `headerTimeout`
+    BODY, // receiving a request body, see `bodyTimeout`
+    WRITE, // the client isn't taking the response, see `writeTimeout`
+  };
+
+  /**
+   * @brief Hands continuations of deferred middleware (see `LGRequest::defer`) to a connection's thread.
+   * Shared by the connection and every continuation handed out for it.
+   * 
+   */
+  struct LGParking {
+    LGConnection* connection; // null once the connection closed, continuations are dropped. Only touched on the connection's thread, or while it is parked
+    LGEventLoop* loop; // where continuations are posted, null for blocking connections
+    LGWorkerPool* workers; // runs a parked blocking connection again once a continuation arrives, null when its thread waits on `ready`
+
+    std::mutex lock;
+    std::condition_variable ready;
+    std::vector<std::function<void(void)>> jobs; // continuations waiting for a blocking connection's thread
+    bool parked; // the blocking connection gave up its worker until a continuation arrives, guarded by `lock`
+  };
+
+  /**
+   * @brief Continues a deferred middleware. May be called from any thread, once.
+   * 
+   */
+  class LGDeferredNext {
+    private:
+    std::shared_ptr<LGParking> parking;
+    unsigned int requestNumber; // the request of the connection it continues
+    size_t position; // the entry of the route matches it continues
+
+    public:
+    LGDeferredNext(std::shared_ptr<LGParking> parking, unsigned int requestNumber, size_t position);
+
+    void operator()() const;
+    void operator()(LGMiddlewareCB then) const;
+  };
+
   /**
    * @brief Includes headers, app, and many properties of the current processed request.
    * 
    */
   class LGRequest : public EventListener {
     private:
-    LGClientSocket socket;
+    LGConnection* connection;
+    std::string bodyData; // the buffered body, empty when bodies are streamed
+    bool bodyRead; // the whole body was received
+    bool collectBody; // buffer a streamed body for body() instead of emitting "data"
+
+    size_t chainPosition; // the entry of the connection's route matches being run
+    size_t heldBy; // the entry whose middleware continues asynchronously, the stack waits for it. NO_HOLDER when there is none
+    bool nextCalled;
+    bool chainRunning; // continueChain is on the stack
+
+#ifdef LG_HAS_COROUTINES
+    struct LGContinuation {
+      std::coroutine_handle<> handle;
+      size_t position;
+    };
+
+    std::pmr::vector<LGContinuation> continuations; // coroutines in `co_await next()`, resumed innermost first once the stack is done
+    std::coroutine_handle<> bodyWaiter; // a coroutine waiting in `co_await receiveBody()`
+    std::pmr::vector<LGTask> tasks; // coroutine middleware that didn't finish right away, destroyed with the request
+
+    void adoptTask(LGTask task, size_t position);
+    void taskFinished(size_t position);
+    void resume(std::coroutine_handle<> handle);
+#endif
+
+    void readHead();
+    void readBody();
+    void fail(int code);
+    void dispatch();
+    void continueChain();
+    void continueDeferred(size_t position, const LGMiddlewareCB& then);
+    void advanceFrom(size_t position);
+    void lend(std::function<void(void)> start);
+    void finish();
 
     public:
-    std::string url;
-    std::string path;
-    std::string method;
-    std::string protocol;
+    std::pmr::string url;
+    std::pmr::string path;
+    std::pmr::string method;
+    std::pmr::string protocol;
+    LGMethod methodId; // `method` parsed once, HTTP_UNKNOWN for non-standard methods
 
     LGHeaders headers;
-    std::unordered_map<std::string, std::string> params;
+    LGStringMap params;
 
     LandingGear* app;
+    LGRequestState state;
 
     LGRequest();
-    LGRequest(LGClientSocket socket);
+    LGRequest(LGConnection* connection);
+
+    LGRequestState getRequest();
+    const std::string& body() const;
+
+    LGDeferredNext defer();
+
+    friend class LGConnection;
+    friend LGMiddlewareCB offload(ReqCallback cb, LGOffloadOptions options);
+
+#ifdef LG_HAS_COROUTINES
+    /**
+     * @brief `co_await req.receiveBody()` suspends until the whole body is in, then gives `body()`.
+     * With `streamBodies`, the part of the body that wasn't emitted as "data" yet is buffered for it.
+     * A separate call since `body()` keeps returning the string for plain handlers.
+     *
+     */
+    struct BodyAwaiter {
+      LGRequest* request;
+
+      bool await_ready() const noexcept { return request->bodyRead; }
+      void await_suspend(std::coroutine_handle<> awaiting) { request->bodyWaiter = awaiting; request->collectBody = true; }
+      const std::string& await_resume() const noexcept { return request->bodyData; }
+    };
+
+    BodyAwaiter receiveBody();
+
+    friend class LGTask;
+    friend class LGNext;
+    friend LGMiddlewareCB coroutine(LGAsyncMiddlewareCB cb);
+#endif
+  };
+
+  /**
+   * @brief A part of a file, eg. one range of a Range header.
+   * 
+   */
+  struct LGByteRange {
+    uint64_t offset;
+    uint64_t length;
+  };
+
+  /**
+   * @brief What `LGResponse::write` returns. True when more can be written right away.
+   * In coroutines, `co_await res.write(chunk)` waits for "drain" instead and gives false
+   * only when the response is over or the connection is broken.
+   *
+   */
+  struct LGWriteResult {
+    LGResponse* response;
+    bool accepted; // more can be written right away
+    bool waiting; // the data was taken, but the response waits for "drain"
 
-    std::string getRequest();
+    operator bool() const { return accepted; }
+
+#ifdef LG_HAS_COROUTINES
+    bool await_ready() const noexcept { return !waiting; }
+    void await_suspend(std::coroutine_handle<> awaiting);
+    bool await_resume() const noexcept { return accepted || waiting; }
+#endif
   };
 
+  // Runs on a body passed to `LGResponse::send` before the head is built. Either rewrites the body and
+  // headers in place and returns false, or sends the response itself (eg. with `sendDeferred`) and returns true
+  typedef std::function<bool(LGResponse& res, std::string& body)> LGBodyFilter;
+
+  /**
+   * @brief Rewrites the body of a streamed response as it is written, eg. to compress it.
+   * Used from whichever thread writes the response.
+   *
+   */
+  class LGStreamEncoder {
+    public:
+    virtual ~LGStreamEncoder() {};
+
+    // The encoded data for the next part of the body, may hold some back. With `flush` nothing is held back
+    virtual std::string encode(std::string_view data, bool flush) = 0;
+    // Whatever is left once the body ended
+    virtual std::string finish() = 0;
+  };
+
+  // Runs when a streamed response starts, before the head is built. Either rewrites the headers in place
+  // and returns the encoder the body goes through, or returns null to send the body as it is
+  typedef std::function<std::unique_ptr<LGStreamEncoder>(LGResponse& res)> LGStreamFilter;
+
   /**
    * @brief Allows to send data from the client.
    * 
    */
   class LGResponse : public EventListener {
     private:
-    LGClientSocket socket;
+    LGConnection* connection;
+    bool chunked; // the streamed body is sent with chunked encoding
+    bool statusSet; // `status` was called, otherwise a stream starts with 200 like `send`
+    std::unique_ptr<LGStreamEncoder> encoder; // from `streamFilter`, the streamed body goes through it
+
+    std::string buildHead(uint64_t contentLength);
+    std::string buildFields();
+    void startStream();
+    int writeChunk(std::string chunk);
+    void complete();
+
+#ifdef LG_HAS_COROUTINES
+    std::coroutine_handle<> drainWaiter; // a coroutine waiting in `co_await write(...)`
+
+    friend class LGConnection;
+    friend struct LGWriteResult;
+#endif
 
     public:
     int statusCode;
     bool headersSent;
+    bool skipBody; // set for HEAD requests, only the headers are written
+    bool streaming; // the head went out with `write` and the response isn't ended yet
+    bool waitingForDrain; // the last `write` returned false, "drain" is emitted once the output is below the high-water mark
 
     LGHeaders headers;
     LandingGear* app;
+    LGBodyFilter bodyFilter; // set by middleware such as `compress`, cleared once it ran
+    LGStreamFilter streamFilter; // the same for streamed responses, runs once the stream starts
 
     LGResponse();
-    LGResponse(LGClientSocket socket);
+    LGResponse(LGConnection* connection);
 
     void header(std::string header, std::string value);
     void header(std::string header, int value);
@@ -121,13 +385,141 @@ namespace LandingGear {
     LGResponse& send(std::string data);
     LGResponse& end(std::string data);
 
+    LGWriteResult write(std::string chunk);
+    LGResponse& flush();
+    LGResponse& end();
+
+    // Text that only converts to a view, eg. request strings allocated from the arena or header values
+    template <typename Text>
+    using IfViewOnly = std::enable_if_t<std::is_convertible_v<const Text&, std::string_view> && !std::is_convertible_v<const Text&, std::string>, int>;
+
+    template <typename Text, IfViewOnly<Text> = 0>
+    LGResponse& send(int code, const Text& data) { return send(code, std::string(std::string_view(data))); }
+    template <typename Text, IfViewOnly<Text> = 0>
+    LGResponse& send(const Text& data) { return send(std::string(std::string_view(data))); }
+    template <typename Text, IfViewOnly<Text> = 0>
+    LGResponse& end(const Text& data) { return end(std::string(std::string_view(data))); }
+
+    LGResponse& sendFile(std::shared_ptr<LGFile> file);
+    LGResponse& sendFile(int code, std::shared_ptr<LGFile> file, uint64_t offset, uint64_t length);
+    LGResponse& sendFileRanges(std::shared_ptr<LGFile> file, const std::vector<LGByteRange>& ranges);
+    LGResponse& sendPrepared(std::shared_ptr<const std::string> prepared);
+    LGResponse& sendDeferred(LGWorkerPool& pool, std::function<std::string(void)> produce);
+
     int sendString(std::string data);
   };
 
-  // Middleware Function Types
-  typedef std::function<void(void)> NextFunction;
-  typedef std::function<void(LGRequest&, LGResponse&, NextFunction)> LGMiddlewareCB; // eg: (req, res, next) -> {}
-  typedef std::function<void(LGRequest&, LGResponse&)> ReqCallback; // eg: (req, res) -> {}
+  /**
+   * @brief A place in a connection's output kept for data still being produced on another thread.
+   * Only touched on the connection's thread.
+   * 
+   */
+  struct LGDeferredOutput {
+    LGConnection* connection; // null once the connection closed, the data is dropped
+  };
+
+  /**
+   * @brief Data waiting to be written to a connection. Either bytes or a range of an open file.
+   * Ranges of mapped files are gathered like bytes, others are sent from the file system.
+   * 
+   */
+  struct LGOutputBuffer {
+    std::string data;
+    std::shared_ptr<const std::string> shared; // when set, sent instead of `data`. Shared with a cache, never modified
+    std::shared_ptr<LGFile> file; // when set, `fileLength` bytes from `fileOffset` are sent instead of `data`
+    uint64_t fileOffset = 0;
+    uint64_t fileLength = 0;
+    std::shared_ptr<LGDeferredOutput> deferred; // when set, the data isn't ready and everything behind it waits
+
+    bool unmappedFile() const;
+    std::string_view bytes() const;
+    uint64_t size() const;
+  };
+
+  /**
+   * @brief A client connection. Owns the socket and buffers data in both directions
+   * so a request can be processed from blocking reads or from event loop readiness.
+   * 
+   */
+  class LGConnection : public LGPollable {
+    private:
+    LGEventLoop* loop; // null when the connection is driven by blocking calls
+    LGWorkerPool* workers; // runs the connection in jobs that end whenever it waits, null when `run` is called directly
+    LGEventLoop* waiter; // watches the socket for `workers` while the connection waits on the client, null to block in receives
+    bool closed;
+    bool peerClosed; // the client will not send anything else
+    bool readPaused; // reading stopped at `inputLimit` with data left in the socket
+    bool corked; // responses are collected in `output` and written together once the current batch of requests is done
+    LGTimer timer; // closes the connection when the client takes too long, only used with an event loop or a waiter
+    LGTimeout timeout; // what `timer` is running for
+    std::chrono::steady_clock::time_point headersDue; // when the head of the current request has to be in, for blocking receives
+    unsigned int timeoutRequest; // the request `timer` was started for
+    int receiveTimeout; // milliseconds the socket's blocking receives are limited to, -1 before it was set
+    bool progressed; // data was received or written since `timer` was started
+    std::unique_ptr<char[]> arenaBuffer; // the first block of `arena`, kept for the connection's lifetime
+    std::shared_ptr<LGParking> parking; // created once middleware defers
+
+    std::function<void(void)> lendTo; // hands the request to another thread once this one is done with it, see `LGRequest::lend`
+    bool lent; // the request and response are used on another thread, nothing else touches the connection meanwhile
+    int lentEvents; // readiness reported while lent, handled once the request is back
+    size_t lentPosition; // the deferred middleware whose continuation gives the request back
+
+    void queue(std::string* buffers, size_t count, size_t offset);
+    int append(std::string head, LGOutputBuffer body);
+    void consume(uint64_t bytes);
+    void completeDeferred(LGDeferredOutput* deferred, std::string data);
+    void resumeDeferred(unsigned int requestNumber, size_t position, const LGMiddlewareCB& then);
+    bool runParked();
+    void lend();
+    LGTimeout pendingTimeout() const;
+    int timeoutLength(LGTimeout kind) const;
+    void updateTimer();
+    void timedOut(LGTimeout kind);
+    void await(int milliseconds);
+    bool readAvailable();
+    size_t inputLimit() const;
+    void processRequests();
+    void nextRequest();
+    void close();
+
+    public:
+    LGClientSocket socket;
+    LandingGear* app;
+
+    std::string input; // received but not yet consumed by a request
+    std::deque<LGOutputBuffer> output; // accepted from responses but not yet taken by the socket, in order
+    uint64_t outputOffset; // bytes of the first output buffer already written
+    uint64_t outputSize; // bytes left to write across all output buffers
+
+    std::pmr::monotonic_buffer_resource arena; // backs the strings and maps of `request` and `response`, released at once between requests
+    LGRequestParser parser; // reused for every request on the connection
+    LGBodyReader bodyReader; // reused for every request on the connection
+    LGRouteMatches routeMatches; // reused for every request on the connection
+    LGRequest request;
+    LGResponse response; // the response to `request`, lives until the next request starts
+    unsigned int requestCount; // requests fully processed on this connection
+    bool keepAlive; // whether the connection is reused once the current request finishes
+
+    LGConnection(LGClientSocket socket, LandingGear* app);
+    LGConnection(LGClientSocket socket, LandingGear* app, LGEventLoop* loop);
+    LGConnection(LGClientSocket socket, LandingGear* app, LGWorkerPool* workers, LGEventLoop* waiter);
+    LGConnection(const LGConnection&) = delete; // the request and response keep a pointer back to the connection
+
+    int write(const char* data, size_t size);
+    int writeBuffers(std::string* buffers, size_t count);
+    int writeFile(std::string head, std::shared_ptr<LGFile> file, uint64_t offset, uint64_t length);
+    int writeShared(std::string head, std::shared_ptr<const std::string> data);
+    int writeDeferred(std::string head, LGWorkerPool& pool, std::function<std::string(void)> produce);
+    bool flush();
+
+    std::shared_ptr<LGParking> getParking();
+
+    void run();
+    void onEvent(int events) override;
+
+    friend class LGDeferredNext;
+    friend class LGRequest;
+  };
 
   /**
    * @brief Main middleware classes.
@@ -136,7 +528,7 @@ namespace LandingGear {
   class LGMiddleware {
     public:
     LGMiddlewareCB cb;
-    std::string method; // if eg: app.get("/home", middlewarefunc) -> "GET"
+    std::string method; // if eg: app.get("/home", middlewarefunc) -> "GET". "USE" and "ALL" match every method
     bool isWildcard;
 
     std::string path;
@@ -151,11 +543,21 @@ namespace LandingGear {
     LGMiddleware(LGMiddlewareCB cb, std::string method);
 
     // Calls the callback (cb)
-    void call(LGRequest& req, LGResponse& res, NextFunction next);
+    void call(LGRequest& req, LGResponse& res, const NextFunction& next) const;
   };
 
   typedef void(*ListenCB)(void);
 
+  /**
+   * @brief How the server waits on its sockets.
+   * 
+   */
+  enum class LGServerMode {
+    THREADS, // blocking writes on a pool of worker threads. Connections waiting on the client give up their worker on Linux,
+             // elsewhere a worker blocks in their receives and drops an idle keep-alive connection while others queue for it
+    EVENT_LOOP, // non-blocking sockets, one epoll loop per worker (Linux only)
+  };
+
   /**
    * @brief To initialize the library and create a ServerSocket.
    * Allows for setting up endpoints and request paths.
@@ -164,17 +566,83 @@ namespace LandingGear {
     private:
     LGServerSocket socket;
     std::thread mainThread;
+    LGWorkerPool pool;
+#ifdef LG_HAS_EPOLL
+    std::unique_ptr<LGEventLoop> waiter; // in thread mode, holds the connections waiting on their client so they don't hold a worker
+#endif
+
+    bool frozen; // set once listen is called, the middleware stack is read-only after that
+    LGRouter router; // the middleware stack compiled into a tree of path segments
+
+    void addMiddleware(LGMiddleware middlew);
+
+    int listenThreads();
+    int listenEventLoop();
 
     public:
-    std::vector<LGMiddleware> middleware; // middleware stack
+    std::vector<LGMiddleware> middleware; // middleware stack, shared by every worker once listening
+    const LGRouter& getRouter() const;
+    unsigned int workers; // amount of worker threads (or event loops) processing requests. 0 uses the hardware concurrency
+    LGServerMode mode;
+    int keepAliveTimeout; // milliseconds an idle keep-alive connection is kept open. 0 is unlimited
+    int headerTimeout; // milliseconds a request line and headers may take to arrive, partial ones are answered with 408. 0 is unlimited
+    int bodyTimeout; // milliseconds a request body may go without new data before it is answered with 408. 0 is unlimited
+    int writeTimeout; // milliseconds the client may go without taking any of a response before the connection is closed. 0 is unlimited
+    unsigned int maxRequestsPerConnection; // a connection is closed after this many requests. 0 is unlimited
+    size_t maxHeaderCount; // requests with more headers are answered with 431
+    size_t maxHeaderLineLength; // longer request lines are answered with 414, longer header lines with 431
+    size_t maxBodySize; // larger request bodies are answered with 413. 0 is unlimited
+    size_t highWaterMark; // bytes a streamed response may have waiting to be written before `write` returns false
+    bool streamBodies; // run the middleware once the headers are in and emit the body as "data" events instead of buffering it for body()
 
     LandingGear();
 
+    void route(std::string method, std::string path, ReqCallback cb);
+    void route(std::string method, std::string path, LGMiddlewareCB cb);
+    void route(std::string method, std::string path, LGMiddlewareCB middle, LGMiddlewareCB cb);
+    void route(std::string method, std::string path, LGMiddlewareCB middle, ReqCallback cb);
+
     void get(std::string path, ReqCallback cb);
     void get(std::string path, LGMiddlewareCB cb);
     void get(std::string path, LGMiddlewareCB middle, LGMiddlewareCB cb);
     void get(std::string path, LGMiddlewareCB middle, ReqCallback cb);
 
+    void post(std::string path, ReqCallback cb);
+    void post(std::string path, LGMiddlewareCB cb);
+    void post(std::string path, LGMiddlewareCB middle, LGMiddlewareCB cb);
+    void post(std::string path, LGMiddlewareCB middle, ReqCallback cb);
+
+    void put(std::string path, ReqCallback cb);
+    void put(std::string path, LGMiddlewareCB cb);
+    void put(std::string path, LGMiddlewareCB middle, LGMiddlewareCB cb);
+    void put(std::string path, LGMiddlewareCB middle, ReqCallback cb);
+
+    // app.delete in Express, `delete` is a keyword
+    void del(std::string path, ReqCallback cb);
+    void del(std::string path, LGMiddlewareCB cb);
+    void del(std::string path, LGMiddlewareCB middle, LGMiddlewareCB cb);
+    void del(std::string path, LGMiddlewareCB middle, ReqCallback cb);
+
+    void patch(std::string path, ReqCallback cb);
+    void patch(std::string path, LGMiddlewareCB cb);
+    void patch(std::string path, LGMiddlewareCB middle, LGMiddlewareCB cb);
+    void patch(std::string path, LGMiddlewareCB middle, ReqCallback cb);
+
+    void head(std::string path, ReqCallback cb);
+    void head(std::string path, LGMiddlewareCB cb);
+    void head(std::string path, LGMiddlewareCB middle, LGMiddlewareCB cb);
+    void head(std::string path, LGMiddlewareCB middle, ReqCallback cb);
+
+    void options(std::string path, ReqCallback cb);
+    void options(std::string path, LGMiddlewareCB cb);
+    void options(std::string path, LGMiddlewareCB middle, LGMiddlewareCB cb);
+    void options(std::string path, LGMiddlewareCB middle, ReqCallback cb);
+
+    void all(std::string path, ReqCallback cb);
+    void all(std::string path, LGMiddlewareCB cb);
+    void all(std::string path, LGMiddlewareCB middle, LGMiddlewareCB cb);
+    void all(std::string path, LGMiddlewareCB middle, ReqCallback cb);
+
     void use(std::string path, LGMiddlewareCB cb);
 
     int listen(int port);
@@ -182,6 +650,18 @@ namespace LandingGear {
   };
 
   LGMiddlewareCB getStatic(std::string folderpath);
+  LGMiddlewareCB getStatic(std::string folderpath, LGStaticOptions options);
+
+  LGMiddlewareCB compress();
+  LGMiddlewareCB compress(LGCompressionOptions options);
+
+  LGMiddlewareCB offload(ReqCallback cb);
+  LGMiddlewareCB offload(ReqCallback cb, LGOffloadOptions options);
+
+#ifdef LG_HAS_COROUTINES
+  LGMiddlewareCB coroutine(LGAsyncMiddlewareCB cb);
+  LGMiddlewareCB coroutine(LGAsyncReqCallback cb);
+#endif
 }; // namespace LandingGear
 
 #endif
\ No newline at end of file
@@ -0,0 +1,113 @@
+/**
+ * @file RequestParser.h
+ * @author Mason Marquez (theboys619@gmail.com)
+ * @brief An incremental HTTP/1.x request head parser that works on the receive buffer in place.
+ * @version 0.1
+ * @date 2022-11-11
+ *
+ * @copyright Copyright (c) 2022
+ *
+ */
+
+#ifndef REQUESTPARSER_H
+#define REQUESTPARSER_H
+
+#include <cstddef>
+#include <cstdint>
+#include <string_view>
+#include <vector>
+
+namespace LandingGear {
+
+  /**
+   * @brief The HTTP request methods.
+   *
+   */
+  enum class LGMethod {
+    HTTP_GET,
+    HTTP_HEAD,
+    HTTP_POST,
+    HTTP_PUT,
+    HTTP_DELETE,
+    HTTP_PATCH,
+    HTTP_OPTIONS,
+    HTTP_CONNECT,
+    HTTP_TRACE,
+    HTTP_UNKNOWN, // anything else, also the amount of known methods
+  };
+
+  static const size_t LG_METHOD_COUNT = (size_t)LGMethod::HTTP_UNKNOWN;
+
+  LGMethod parseMethod(std::string_view method);
+  const char* methodName(LGMethod method);
+
+  /**
+   * @brief Result of feeding data to the parser.
+   *
+   */
+  enum class LGParseResult {
+    INCOMPLETE, // more data is needed
+    COMPLETE, // the request line and all headers have been parsed
+    ERROR, // the request is malformed or exceeds a limit, see `errorCode`
+  };
+
+  /**
+   * @brief A header as views into the parsed buffer.
+   *
+   */
+  struct LGHeaderView {
+    std::string_view name;
+    std::string_view value;
+  };
+
+  /**
+   * @brief Parses the request line and headers of one request. The buffer may grow between calls,
+   * already parsed lines are not looked at again. Views are only valid until the buffer is modified.
+   *
+   */
+  class LGRequestParser {
+    private:
+    struct Span {
+      uint32_t offset;
+      uint32_t length;
+    };
+
+    struct HeaderSpan {
+      Span name;
+      Span value;
+    };
+
+    size_t position; // start of the first line that has not been parsed
+    bool gotRequestLine;
+
+    Span methodSpan;
+    Span pathSpan;
+    Span protocolSpan;
+    std::vector<HeaderSpan> headerSpans;
+
+    LGParseResult fail(int code);
+    bool parseRequestLine(const char* data, size_t start, size_t end);
+    bool parseHeaderLine(const char* data, size_t start, size_t end);
+
+    public:
+    size_t maxHeaders; // more headers than this fails with 431
+    size_t maxLineLength; // longer lines fail with 414 (request line) or 431 (header)
+
+    int errorCode; // the status code to answer with after an ERROR
+    size_t consumed; // size of the request head, including the blank line, after COMPLETE
+
+    LGMethod methodId;
+    std::string_view method;
+    std::string_view path;
+    std::string_view protocol;
+    std::vector<LGHeaderView> headers;
+
+    LGRequestParser();
+
+    void reset();
+    LGParseResult parse(const char* data, size_t size);
+  };
+
+}; // namespace LandingGear
+
+#endif
@@ -0,0 +1,95 @@
+/**
+ * @file Router.h
+ * @author Mason Marquez (theboys619@gmail.com)
+ * @brief A prefix tree of route patterns. Finds every middleware that applies to a path in one walk.
+ * @version 0.1
+ * @date 2022-11-11
+ *
+ * @copyright Copyright (c) 2022
+ *
+ */
+
+#ifndef ROUTER_H
+#define ROUTER_H
+
+#include "RequestParser.h"
+
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace LandingGear {
+
+  /**
+   * @brief A middleware that applies to the matched path.
+   *
+   */
+  struct LGRouteMatch {
+    size_t index; // position in the middleware stack
+    const std::vector<std::string>* paramNames; // names of the `:param` segments of the pattern
+    size_t paramStart; // first captured value in `LGRouteMatches::values`
+  };
+
+  /**
+   * @brief Results of `LGRouter::match`, sorted by middleware stack position.
+   * Reuse one instance to avoid allocating on every match.
+   *
+   */
+  class LGRouteMatches {
+    public:
+    std::vector<LGRouteMatch> matches;
+    std::vector<std::string_view> values; // captured `:param` values, views into the matched path
+    std::vector<std::string_view> captures; // values captured along the branch being walked
+    bool routeMatched; // whether a route for the method matched, not just mounts
+
+    void clear();
+
+    size_t size() const;
+    const LGRouteMatch& operator[] (size_t i) const;
+  };
+
+  /**
+   * @brief Route patterns compiled into a tree of path segments. Static segments, `:param` segments
+   * (match any one segment and capture it) and `*` segments (match any one segment) are separate nodes.
+   * Every method has its own tree, routes for every method (`app.all`) and mounts (`app.use`) live in trees shared by all methods.
+   *
+   */
+  class LGRouter {
+    private:
+    struct Entry {
+      size_t index;
+      std::vector<std::string> paramNames;
+    };
+
+    struct Node {
+      std::vector<std::pair<std::string, std::unique_ptr<Node>>> children; // static segments, sorted
+      std::unique_ptr<Node> param;
+      std::unique_ptr<Node> wildcard;
+
+      std::vector<Entry> routes; // match when the path ends at this node
+      std::vector<Entry> mounts; // match this node and everything below it
+    };
+
+    Node mountRoot;
+    Node anyRoot; // routes of every standard method
+    Node methodRoots[LG_METHOD_COUNT];
+
+    void insert(Node* root, std::string_view pattern, size_t index, bool mount);
+    void matchNode(const Node* node, std::string_view rest, LGRouteMatches& results) const;
+    bool hasRoute(const Node* node, std::string_view rest) const;
+    void record(const Entry& entry, LGRouteMatches& results) const;
+
+    public:
+    void add(std::string_view pattern, LGMethod method, size_t index);
+    void addAny(std::string_view pattern, size_t index);
+    void mount(std::string_view pattern, size_t index);
+
+    void match(std::string_view path, LGMethod method, LGRouteMatches& results) const;
+    uint32_t allowedMethods(std::string_view path) const;
+  };
+
+}; // namespace LandingGear
+
+#endif
@@ -0,0 +1,39 @@
+/**
+ * @file Scan.h
+ * @author Mason Marquez (theboys619@gmail.com)
+ * @brief Byte scanning kernels used by the request parser. Picks AVX2, SSE2 or plain loops at runtime.
+ * @version 0.1
+ * @date 2022-11-11
+ *
+ * @copyright Copyright (c) 2022
+ *
+ */
+
+#ifndef SCAN_H
+#define SCAN_H
+
+namespace LandingGear {
+
+  /**
+   * @brief Finds the first byte equal to `c`.
+   *
+   * @return const char* The matching byte, or `end` if there is none
+   */
+  const char* scanFor(const char* begin, const char* end, char c);
+
+  /**
+   * @brief Skips spaces and tabs.
+   *
+   * @return const char* The first byte that is not a space or tab, or `end`
+   */
+  const char* skipBlanks(const char* begin, const char* end);
+
+  /**
+   * @brief The instruction set the kernels were dispatched to. ("avx2", "sse2" or "scalar")
+   *
+   */
+  const char* scanImplementation();
+
+}; // namespace LandingGear
+
+#endif
@@ -0,0 +1,153 @@
+/**
+ * @file StaticFiles.h
+ * @author Mason Marquez (theboys619@gmail.com)
+ * @brief Serving files from a folder. Keeps recently used files open so hot files skip the file system.
+ * @version 0.1
+ * @date 2022-11-11
+ *
+ * @copyright Copyright (c) 2022
+ *
+ */
+
+#ifndef STATICFILES_H
+#define STATICFILES_H
+
+#if defined(WIN32) || defined(_WIN32) || defined(__WIN32__) || defined(_WIN64)
+#include "winlib.h"
+#else
+#include "posixlib.h"
+#endif
+
+#include <atomic>
+#include <chrono>
+#include <list>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+
+namespace LandingGear {
+
+  class LGAssetCache;
+
+  /**
+   * @brief Settings for `getStatic`.
+   *
+   */
+  struct LGStaticOptions {
+    size_t maxOpenFiles = 256; // files kept open between requests, least recently used are closed first
+    bool memoryMap = false; // send open files from read-only mappings shared by every worker. Only for files replaced, never truncated, while served
+    int revalidateInterval = 1000; // milliseconds a cached file is trusted before checking whether it changed on disk
+    size_t memoryBudget = 8 * 1024 * 1024; // bytes of small files kept in memory as ready to send responses. 0 disables it
+    size_t maxCachedFileSize = 256 * 1024; // larger files are always sent from disk
+    std::shared_ptr<LGAssetCache> assetCache; // created from the settings above when null. Pass one to read its stats
+    std::string cacheControl = "public, max-age=0"; // Cache-Control of every file in the folder, empty to leave it out
+    bool etag = true; // send ETag (from size and modification time) and answer If-None-Match with 304
+    bool lastModified = true; // send Last-Modified and answer If-Modified-Since with 304
+    size_t maxRanges = 16; // ranges of one Range header served as 206, more are answered with the whole file. 0 disables ranges
+  };
+
+  // Encodings a cached asset can be sent in. Precompressed variants are read from ".gz" and ".br" files next to the original.
+  enum LGAssetEncoding {
+    LG_ENCODING_IDENTITY,
+    LG_ENCODING_GZIP,
+    LG_ENCODING_BROTLI,
+    LG_ENCODING_COUNT,
+  };
+
+  bool acceptsEncoding(std::string_view header, std::string_view encoding);
+
+  /**
+   * @brief A small file prepared for sending. Every variant holds the headers after the Connection and Date headers,
+   * the blank line and the body, so a response is the status line plus one shared buffer.
+   *
+   */
+  struct LGCachedAsset {
+    std::shared_ptr<const std::string> variants[LG_ENCODING_COUNT]; // null when the file has no such variant
+    LGFileInfo sources[LG_ENCODING_COUNT]; // what the variants were read from, to notice changes
+    std::string etags[LG_ENCODING_COUNT]; // quoted entity tags of the variants, to answer If-None-Match
+    size_t size; // bytes of all variants
+  };
+
+  /**
+   * @brief Counters of an `LGAssetCache`, to size its budget.
+   *
+   */
+  struct LGAssetCacheStats {
+    uint64_t hits;
+    uint64_t misses;
+    uint64_t evictions; // assets dropped to stay within the budget
+    size_t entries;
+    size_t bytes;
+  };
+
+  /**
+   * @brief Prepared responses for small files, least recently used are dropped once the memory budget
+   * is exceeded. Hits don't touch the file system, except for a stat of the variants once per
+   * revalidate interval. Safe to use from every worker.
+   *
+   */
+  class LGAssetCache {
+    private:
+    struct Entry {
+      std::shared_ptr<const LGCachedAsset> asset;
+      std::chrono::steady_clock::time_point checked; // last time the files were known to be unchanged
+      std::list<std::string>::iterator position; // in `recent`
+    };
+
+    std::mutex mutex;
+    std::unordered_map<std::string, Entry> entries;
+    std::list<std::string> recent; // most recently used first
+    size_t used; // bytes of all cached assets
+
+    std::atomic<uint64_t> hits;
+    std::atomic<uint64_t> misses;
+    std::atomic<uint64_t> evictions;
+
+    void erase(std::unordered_map<std::string, Entry>::iterator entry);
+
+    public:
+    const size_t budget;
+    const size_t maxAssetSize;
+    const std::chrono::milliseconds revalidateInterval;
+
+    LGAssetCache(size_t budget, size_t maxAssetSize, int revalidateInterval);
+
+    std::shared_ptr<const LGCachedAsset> find(const std::string& path);
+    void insert(const std::string& path, std::shared_ptr<const LGCachedAsset> asset);
+
+    LGAssetCacheStats stats();
+  };
+
+  /**
+   * @brief Open files by path, least recently used are closed first. A file that changed on disk
+   * (new size, modification time or inode) is reopened. Safe to use from every worker.
+   * Files stay open (and mapped) for responses still sending them after they are evicted.
+   *
+   */
+  class LGFileCache {
+    private:
+    struct Entry {
+      std::shared_ptr<LGFile> file;
+      std::chrono::steady_clock::time_point checked; // last time the file was known to be unchanged
+      std::list<std::string>::iterator position; // in `recent`
+    };
+
+    std::mutex mutex;
+    std::unordered_map<std::string, Entry> entries;
+    std::list<std::string> recent; // most recently used first
+
+    size_t capacity;
+    std::chrono::milliseconds revalidateInterval;
+    bool memoryMap; // map files as they are opened, files that can't be mapped are read instead
+
+    public:
+    LGFileCache(size_t capacity, int revalidateInterval, bool memoryMap);
+
+    std::shared_ptr<LGFile> open(const std::string& path);
+  };
+
+}; // namespace LandingGear
+
+#endif
@@ -0,0 +1,112 @@
+/**
+ * @file Task.h
+ * @author Mason Marquez (theboys619@gmail.com)
+ * @brief Coroutine handlers. Only available when compiled as C++20 or later.
+ * @version 0.1
+ * @date 2022-11-11
+ *
+ * @copyright Copyright (c) 2022
+ *
+ */
+
+#ifndef TASK_H
+#define TASK_H
+
+#if defined(__cpp_impl_coroutine) && defined(__has_include)
+#if __has_include(<coroutine>)
+#define LG_HAS_COROUTINES
+#endif
+#endif
+
+#ifdef LG_HAS_COROUTINES
+
+#include <coroutine>
+#include <cstddef>
+#include <exception>
+#include <utility>
+
+namespace LandingGear {
+
+  class LGRequest;
+
+  /**
+   * @brief What coroutine handlers return. Runs right away, up to the first `co_await` that has to wait.
+   * Either run by a request's middleware stack (see `coroutine`) or awaited by another task.
+   *
+   */
+  class LGTask {
+    public:
+    struct promise_type;
+    typedef std::coroutine_handle<promise_type> Handle;
+
+    // Hands control to the awaiting task, or tells the request the handler is done
+    struct FinalAwaiter {
+      bool await_ready() noexcept { return false; }
+      std::coroutine_handle<> await_suspend(Handle handle) noexcept;
+      void await_resume() noexcept {}
+    };
+
+    struct promise_type {
+      LGRequest* request = nullptr; // the request running the handler, null for tasks awaited by other tasks
+      size_t position = 0; // the entry of the request's route matches that started the handler
+      std::coroutine_handle<> continuation; // the task awaiting this one
+      std::exception_ptr error;
+
+      LGTask get_return_object() { return LGTask(Handle::from_promise(*this)); }
+      std::suspend_never initial_suspend() noexcept { return {}; }
+      FinalAwaiter final_suspend() noexcept { return {}; }
+      void return_void() {}
+      void unhandled_exception() { error = std::current_exception(); }
+    };
+
+    LGTask();
+    explicit LGTask(Handle handle);
+    LGTask(LGTask&& other) noexcept;
+    LGTask(const LGTask&) = delete;
+    ~LGTask();
+
+    LGTask& operator=(LGTask&& other) noexcept;
+
+    bool done() const;
+    void result() const; // rethrows what escaped the coroutine
+
+    bool await_ready() const;
+    void await_suspend(std::coroutine_handle<> awaiting);
+    void await_resume() const;
+
+    private:
+    Handle handle;
+
+    friend class LGRequest;
+  };
+
+  /**
+   * @brief The `next` of coroutine middleware. Calling it moves on to the next middleware like with
+   * plain middleware, `co_await next()` also suspends the caller until the rest of the stack is done.
+   *
+   */
+  class LGNext {
+    private:
+    LGRequest* request;
+    size_t position; // the entry of the route matches `next` belongs to
+
+    public:
+    struct Awaiter {
+      LGRequest* request;
+      size_t position;
+
+      bool await_ready() const noexcept { return false; }
+      void await_suspend(std::coroutine_handle<> awaiting);
+      void await_resume() const noexcept {}
+    };
+
+    LGNext(LGRequest* request, size_t position);
+
+    Awaiter operator()() const;
+  };
+
+}; // namespace LandingGear
+
+#endif
+
+#endif
@@ -0,0 +1,77 @@
+/**
+ * @file TimerWheel.h
+ * @author Mason Marquez (theboys619@gmail.com)
+ * @brief A hierarchical timer wheel. Scheduling and cancelling are O(1), so timers can be reset on every read.
+ * @version 0.1
+ * @date 2022-11-11
+ *
+ * @copyright Copyright (c) 2022
+ *
+ */
+
+#ifndef TIMERWHEEL_H
+#define TIMERWHEEL_H
+
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+
+namespace LandingGear {
+
+  static const int LG_TIMER_TICK_MS = 100; // resolution of the wheel, timers expire at most one tick late
+  static const size_t LG_TIMER_SLOT_BITS = 6;
+  static const size_t LG_TIMER_SLOTS = 1 << LG_TIMER_SLOT_BITS; // slots per level
+  static const size_t LG_TIMER_LEVELS = 4; // each level covers LG_TIMER_SLOTS times the span of the one below, about 19 days in total
+
+  // A place in one of the circular lists of a wheel, either a timer or the head of a slot.
+  struct LGTimerLink {
+    LGTimerLink* prev = nullptr;
+    LGTimerLink* next = nullptr; // null while the timer isn't scheduled
+  };
+
+  /**
+   * @brief A timer that can be scheduled on a wheel, usually a member of the object it times out.
+   * Cancelled when destroyed.
+   *
+   */
+  class LGTimer : public LGTimerLink {
+    public:
+    uint64_t expires = 0; // the tick of the wheel it expires at
+    std::function<void(void)> onExpire; // runs on the wheel's thread. May delete the timer
+
+    LGTimer() {};
+    LGTimer(const LGTimer&) = delete;
+    ~LGTimer();
+
+    bool scheduled() const;
+    void cancel();
+  };
+
+  /**
+   * @brief Timers sorted into slots by expiry. The lowest level has one slot per tick, timers further out
+   * sit in the coarser slots of higher levels and move down whenever the level below has gone around once.
+   * Only used from one thread.
+   *
+   */
+  class LGTimerWheel {
+    private:
+    LGTimerLink slots[LG_TIMER_LEVELS][LG_TIMER_SLOTS]; // heads of the circular lists of timers
+    uint64_t current; // the last tick handled
+    std::chrono::steady_clock::time_point start;
+
+    void place(LGTimer* timer);
+    void cascade(size_t level, size_t index);
+    void expire(size_t index);
+
+    public:
+    LGTimerWheel();
+    LGTimerWheel(const LGTimerWheel&) = delete; // the slots point at themselves
+
+    void schedule(LGTimer& timer, int milliseconds);
+    void advance(std::chrono::steady_clock::time_point now);
+  };
+
+}; // namespace LandingGear
+
+#endif
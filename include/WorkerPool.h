@@ -0,0 +1,82 @@
+/**
+ * @file WorkerPool.h
+ * @author Mason Marquez (theboys619@gmail.com)
+ * @brief A work-stealing thread pool used to process client connections in parallel.
+ * @version 0.1
+ * @date 2022-11-11
+ *
+ * @copyright Copyright (c) 2022
+ *
+ */
+
+#ifndef WORKERPOOL_H
+#define WORKERPOOL_H
+
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace LandingGear {
+
+  typedef std::function<void(void)> LGJob; // A unit of work submitted to the pool.
+
+  /**
+   * @brief A fixed size thread pool. Every worker owns a queue, idle workers steal from the others.
+   *
+   */
+  class LGWorkerPool {
+    private:
+    struct WorkerQueue {
+      std::mutex lock;
+      std::deque<LGJob> jobs;
+    };
+
+    std::vector<std::unique_ptr<WorkerQueue>> queues;
+    std::vector<std::thread> threads;
+
+    std::mutex sleepLock;
+    std::condition_variable wakeup;
+
+    std::atomic<size_t> pending;
+    std::atomic<size_t> nextQueue;
+    bool running;
+
+    bool pop(size_t index, LGJob& job);
+    bool steal(size_t index, LGJob& job);
+    void work(size_t index);
+
+    public:
+    LGWorkerPool();
+    ~LGWorkerPool();
+
+    LGWorkerPool(const LGWorkerPool&) = delete;
+    LGWorkerPool& operator=(const LGWorkerPool&) = delete;
+
+    void start(size_t count);
+    void stop();
+
+    void submit(LGJob job);
+
+    size_t size() const;
+    size_t queued() const;
+  };
+
+  /**
+   * @brief Settings for `offload`.
+   *
+   */
+  struct LGOffloadOptions {
+    unsigned int threads = 0; // size of the pool created when `pool` is null. 0 uses the hardware concurrency
+    size_t maxPending = 256; // requests of the route queued or running on the pool at once, more are answered with 503. 0 is unlimited
+    std::shared_ptr<LGWorkerPool> pool; // created from `threads` when null, may be shared between routes
+  };
+
+}; // namespace LandingGear
+
+#endif
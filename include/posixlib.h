@@ -13,11 +13,165 @@
 #define POSIXLIB_H
 
 #include <iostream>
+#include <string>
+#include <cerrno>
+#include <csignal>
+#include <cstdint>
+#include <fcntl.h>
+#include <sys/mman.h>
 #include <sys/socket.h>
+#include <sys/stat.h>
+#include <sys/time.h>
+#include <sys/uio.h>
 #include <netinet/in.h>
 #include <unistd.h>
 
+#ifdef __linux__
+#include <sys/sendfile.h>
+#endif
+
+#ifndef MSG_NOSIGNAL
+#define MSG_NOSIGNAL 0
+#endif
+
+// Most buffers handed to one gathered send
+#define LG_MAX_SEND_BUFFERS 64
+
 namespace LandingGear {
+
+  /**
+   * A piece of data for a gathered send.
+  */
+  struct LGSendBuffer {
+    const char* data;
+    size_t size;
+  };
+
+  /**
+   * What stat says about a file. Used to notice when a file changed on disk.
+  */
+  struct LGFileInfo {
+    uint64_t size;
+    int64_t modified; // modification time in nanoseconds since the epoch
+    uint64_t id; // device and inode, changes when the file is replaced
+    bool regular;
+  };
+
+  /**
+   * Wrapper class for read-only files. Closes the file once destroyed.
+  */
+  class LGFile {
+    private:
+    int fd;
+    void* mapped; // the whole file when mapped, null otherwise
+
+    static void fill(const struct stat& st, LGFileInfo& info) {
+      info.size = st.st_size;
+#ifdef __linux__
+      info.modified = (int64_t)st.st_mtim.tv_sec * 1000000000 + st.st_mtim.tv_nsec;
+#else
+      info.modified = (int64_t)st.st_mtime * 1000000000;
+#endif
+      info.id = ((uint64_t)st.st_dev << 32) ^ (uint64_t)st.st_ino;
+      info.regular = S_ISREG(st.st_mode);
+    }
+
+    public:
+    LGFileInfo info;
+
+    LGFile(int fd, LGFileInfo info): fd(fd), mapped(nullptr), info(info) {};
+    LGFile(const LGFile&) = delete;
+
+    ~LGFile() {
+      if (mapped != nullptr) munmap(mapped, info.size);
+      ::close(fd);
+    }
+
+    int getHandle() const {
+      return fd;
+    }
+
+    /**
+     * Reads up to `size` bytes starting at `offset`, without moving a file position.
+     * 
+     * @returns The amount of bytes read, 0 at the end of the file, -1 on error
+    */
+    int readAt(char* buffer, size_t size, uint64_t offset) const {
+      return pread(fd, buffer, size, offset);
+    }
+
+    /**
+     * Maps the whole file read-only, so it is sent from pages shared by every thread instead of being read
+     * for each send. Stays mapped until the file is destroyed. Must be called before the file is shared.
+     * A mapped file that is truncated while being sent crashes the process (SIGBUS), only map files
+     * that are replaced rather than modified in place.
+     * 
+     * @param sequential Whether the file is mostly read start to end (large files), otherwise it is read ahead at once
+     * @returns true - The file is mapped. false - Empty file or a file system that can't map it, it is read instead
+    */
+    bool map(bool sequential) {
+      if (mapped != nullptr) return true;
+      if (info.size == 0 || info.size > SIZE_MAX) return false;
+
+      void* address = mmap(nullptr, (size_t)info.size, PROT_READ, MAP_SHARED, fd, 0);
+      if (address == MAP_FAILED) return false;
+
+      madvise(address, (size_t)info.size, sequential ? MADV_SEQUENTIAL : MADV_WILLNEED);
+
+      mapped = address;
+      return true;
+    }
+
+    /**
+     * The contents of a mapped file.
+     * 
+     * @returns The first byte, nullptr if the file isn't mapped
+    */
+    const char* mappedData() const {
+      return (const char*)mapped;
+    }
+
+    /**
+     * Looks up a file without opening it.
+     * 
+     * @returns true - The file exists
+    */
+    static bool stat(const std::string& path, LGFileInfo& info) {
+      struct stat st;
+
+      if (::stat(path.c_str(), &st) != 0) return false;
+
+      fill(st, info);
+      return true;
+    }
+
+    /**
+     * Opens a regular file for reading.
+     * 
+     * @returns The file, nullptr if it does not exist or isn't a regular file
+    */
+    static LGFile* open(const std::string& path) {
+      int fd = ::open(path.c_str(), O_RDONLY | O_CLOEXEC);
+      if (fd < 0) return nullptr;
+
+      struct stat st;
+      LGFileInfo info;
+
+      if (fstat(fd, &st) != 0) {
+        ::close(fd);
+        return nullptr;
+      }
+
+      fill(st, info);
+
+      if (!info.regular) {
+        ::close(fd);
+        return nullptr;
+      }
+
+      return new LGFile(fd, info);
+    }
+  };
   
   /**
    * Wrapper class for client sockets. Allows for easy and similar use of sockets between platforms.
@@ -36,16 +190,119 @@ namespace LandingGear {
       return socket > 0;
     }
 
+    int getSocket() const {
+      return socket;
+    }
+
     void setSockAddr(struct sockaddr_in s) {
       sockAddr = s;
     }
 
+    /**
+     * Puts the socket in non-blocking mode.
+     * 
+     * @returns 1 - Error, 0 - Success
+    */
+    int setNonBlocking() {
+      int flags = fcntl(socket, F_GETFL, 0);
+
+      if (flags < 0 || fcntl(socket, F_SETFL, flags | O_NONBLOCK) < 0) {
+        std::cerr << "Could not make socket non-blocking!" << std::endl;
+        return 1;
+      }
+
+      return 0;
+    }
+
+    /**
+     * Makes blocking receives fail once nothing arrived for the given time.
+     * 
+     * @returns 1 - Error, 0 - Success
+    */
+    int setReceiveTimeout(int milliseconds) {
+      struct timeval timeout;
+      timeout.tv_sec = milliseconds / 1000;
+      timeout.tv_usec = (milliseconds % 1000) * 1000;
+
+      return setsockopt(socket, SOL_SOCKET, SO_RCVTIMEO, &timeout, sizeof(timeout)) < 0 ? 1 : 0;
+    }
+
+    /**
+     * Makes blocking sends fail once the client took nothing for the given time.
+     * 
+     * @returns 1 - Error, 0 - Success
+    */
+    int setSendTimeout(int milliseconds) {
+      struct timeval timeout;
+      timeout.tv_sec = milliseconds / 1000;
+      timeout.tv_usec = (milliseconds % 1000) * 1000;
+
+      return setsockopt(socket, SOL_SOCKET, SO_SNDTIMEO, &timeout, sizeof(timeout)) < 0 ? 1 : 0;
+    }
+
+    /**
+     * Whether the last failed blocking receive/send failed because its timeout passed.
+    */
+    bool timedOut() const {
+      return errno == EAGAIN || errno == EWOULDBLOCK;
+    }
+
+    /**
+     * Whether the last failed receive/send only failed because a non-blocking socket was not ready.
+    */
+    bool wouldBlock() const {
+      return errno == EAGAIN || errno == EWOULDBLOCK;
+    }
+
     int receive(char* recvbuf, size_t recvbuflen, int flags = 0) {
       return recv(socket, recvbuf, recvbuflen, flags);
     }
 
-    int send(char* recvbuf, size_t recvbuflen, int flags = 0) {
-      return ::send(socket, recvbuf, recvbuflen, flags);
+    int send(const char* recvbuf, size_t recvbuflen, int flags = 0) {
+      return ::send(socket, recvbuf, recvbuflen, flags | MSG_NOSIGNAL);
+    }
+
+    /**
+     * Sends several buffers with one call. At most LG_MAX_SEND_BUFFERS are sent.
+     * 
+     * @returns The amount of bytes sent, which may end partway through a buffer. -1 on error
+    */
+    int sendv(const LGSendBuffer* buffers, size_t count) {
+      struct iovec vectors[LG_MAX_SEND_BUFFERS];
+      struct msghdr message = {};
+
+      if (count > LG_MAX_SEND_BUFFERS) count = LG_MAX_SEND_BUFFERS;
+
+      for (size_t i = 0; i < count; i++) {
+        vectors[i].iov_base = (void*)buffers[i].data;
+        vectors[i].iov_len = buffers[i].size;
+      }
+
+      message.msg_iov = vectors;
+      message.msg_iovlen = count;
+
+      return sendmsg(socket, &message, MSG_NOSIGNAL);
+    }
+
+    /**
+     * Sends part of a file. Uses sendfile where available so the data never passes through user space.
+     * 
+     * @returns The amount of bytes sent, 0 if the file ended early. -1 on error
+    */
+    int sendFile(const LGFile& file, uint64_t offset, uint64_t length) {
+      if (length > (1 << 30)) length = 1 << 30;
+
+#ifdef __linux__
+      off_t position = offset;
+      return ::sendfile(socket, file.getHandle(), &position, length);
+#else
+      char buffer[64 * 1024];
+      int bytes = file.readAt(buffer, length < sizeof(buffer) ? length : sizeof(buffer), offset);
+
+      if (bytes <= 0) return bytes;
+
+      return send(buffer, bytes);
+#endif
     }
 
     /**
@@ -59,15 +316,37 @@ namespace LandingGear {
 
   class LGServerSocket {
     private:
-    int socket;
+    int socket = -1;
     struct sockaddr_in addr;
+    int acceptError = 0; // errno of the last failed accept
 
     public:
     int port = 8080;
+    bool reusePort = false; // lets several sockets bind the same port, the kernel balances connections between them
 
     LGServerSocket() {};
     LGServerSocket(int port): port(port) {};
 
+    int getSocket() const {
+      return socket;
+    }
+
+    /**
+     * Puts the socket in non-blocking mode. `accept` then returns an uninitialized socket when nothing is pending.
+     * 
+     * @returns 1 - Error, 0 - Success
+    */
+    int setNonBlocking() {
+      int flags = fcntl(socket, F_GETFL, 0);
+
+      if (flags < 0 || fcntl(socket, F_SETFL, flags | O_NONBLOCK) < 0) {
+        std::cerr << "Could not make server socket non-blocking!" << std::endl;
+        return 1;
+      }
+
+      return 0;
+    }
+
     /**
      * Accepts the next available connection.
      * 
@@ -82,14 +361,33 @@ namespace LandingGear {
       csocket.setSockAddr(sockAddr);
 
       if (clientSock < 0) {
-        std::cerr << "Could not accept socket!" << std::endl;
-        csocket.close();
+        acceptError = errno;
+
+        if (!wouldBlock()) {
+          std::cerr << "Could not accept socket!" << std::endl;
+        }
         return LGClientSocket(-1);
       }
 
+      acceptError = 0;
       return csocket;
     }
 
+    /**
+     * Whether the last `accept` failed only because nothing was pending on a non-blocking socket.
+    */
+    bool wouldBlock() const {
+      return acceptError == EAGAIN || acceptError == EWOULDBLOCK;
+    }
+
+    /**
+     * Whether the last `accept` failed because the process or system ran out of descriptors or memory.
+     * The connection stays pending, so accepting again later can succeed.
+    */
+    bool outOfResources() const {
+      return acceptError == EMFILE || acceptError == ENFILE || acceptError == ENOBUFS || acceptError == ENOMEM;
+    }
+
     /**
      * Close server socket connection.
     */
@@ -105,7 +403,7 @@ namespace LandingGear {
     int listen() {
       int results = 0;
 
-      results = ::listen(socket, 5);
+      results = ::listen(socket, SOMAXCONN);
       if (results < 0) {
           std::cerr << "Failed to listen!" << std::endl;
           return 1;
@@ -122,6 +420,9 @@ namespace LandingGear {
     int initSocket() {
       socket = -1;
 
+      // sendfile has no MSG_NOSIGNAL, a client hanging up mid-file must not kill the server
+      signal(SIGPIPE, SIG_IGN);
+
       addr.sin_addr.s_addr = INADDR_ANY;
       addr.sin_port = htons(port);
       addr.sin_family = AF_INET;
@@ -139,6 +440,12 @@ namespace LandingGear {
 
       setsockopt(socket, SOL_SOCKET, SO_REUSEADDR, &opt, sizeof(int));
 
+#ifdef SO_REUSEPORT
+      if (reusePort) {
+        setsockopt(socket, SOL_SOCKET, SO_REUSEPORT, &opt, sizeof(int));
+      }
+#endif
+
       results = ::bind(socket, (struct sockaddr*)&addr, sizeof(addr));
 
       if (results < 0) {
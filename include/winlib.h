@@ -17,7 +17,9 @@
 
 #define WIN32_LEAN_AND_MEAN
 
+#include <cstdint>
 #include <iostream>
+#include <string>
 #include <windows.h>
 #include <winsock2.h>
 #include <ws2tcpip.h>
@@ -28,8 +30,154 @@
 // Need to link with Ws2_32.lib
 #pragma comment (lib, "Ws2_32.lib")
 
+// Most buffers handed to one gathered send
+#define LG_MAX_SEND_BUFFERS 64
+
 namespace LandingGear {
 
+  /**
+   * A piece of data for a gathered send.
+  */
+  struct LGSendBuffer {
+    const char* data;
+    size_t size;
+  };
+
+  /**
+   * What the file system says about a file. Used to notice when a file changed on disk.
+  */
+  struct LGFileInfo {
+    uint64_t size;
+    int64_t modified; // modification time in nanoseconds since the epoch
+    uint64_t id; // volume and file index, changes when the file is replaced
+    bool regular;
+  };
+
+  /**
+   * Wrapper class for read-only files. Closes the file once destroyed.
+  */
+  class LGFile {
+    private:
+    HANDLE handle;
+    void* mapped; // the whole file when mapped, null otherwise
+
+    static void fill(const BY_HANDLE_FILE_INFORMATION& data, LGFileInfo& info) {
+      info.size = ((uint64_t)data.nFileSizeHigh << 32) | data.nFileSizeLow;
+      int64_t fileTime = ((int64_t)data.ftLastWriteTime.dwHighDateTime << 32) | data.ftLastWriteTime.dwLowDateTime; // 100ns since 1601
+
+      info.modified = (fileTime - 116444736000000000LL) * 100;
+      info.id = (((uint64_t)data.nFileIndexHigh << 32) | data.nFileIndexLow) ^ ((uint64_t)data.dwVolumeSerialNumber << 32);
+      info.regular = !(data.dwFileAttributes & FILE_ATTRIBUTE_DIRECTORY);
+    }
+
+    public:
+    LGFileInfo info;
+
+    LGFile(HANDLE handle, LGFileInfo info): handle(handle), mapped(nullptr), info(info) {};
+    LGFile(const LGFile&) = delete;
+
+    ~LGFile() {
+      if (mapped != NULL) UnmapViewOfFile(mapped);
+      CloseHandle(handle);
+    }
+
+    HANDLE getHandle() const {
+      return handle;
+    }
+
+    /**
+     * Reads up to `size` bytes starting at `offset`.
+     * 
+     * @returns The amount of bytes read, 0 at the end of the file, -1 on error
+    */
+    int readAt(char* buffer, size_t size, uint64_t offset) const {
+      OVERLAPPED position = {};
+      DWORD bytes = 0;
+
+      position.Offset = (DWORD)offset;
+      position.OffsetHigh = (DWORD)(offset >> 32);
+
+      if (!ReadFile(handle, buffer, (DWORD)size, &bytes, &position)) {
+        return GetLastError() == ERROR_HANDLE_EOF ? 0 : -1;
+      }
+
+      return (int)bytes;
+    }
+
+    /**
+     * Maps the whole file read-only, so it is sent from pages shared by every thread instead of being read
+     * for each send. Stays mapped until the file is destroyed. Must be called before the file is shared.
+     * 
+     * @param sequential Unused, Windows has no read ahead hints for views
+     * @returns true - The file is mapped. false - Empty file or a file system that can't map it, it is read instead
+    */
+    bool map(bool sequential) {
+      if (mapped != NULL) return true;
+      if (info.size == 0 || info.size > SIZE_MAX) return false;
+
+      HANDLE mapping = CreateFileMappingA(handle, NULL, PAGE_READONLY, 0, 0, NULL);
+      if (mapping == NULL) return false;
+
+      mapped = MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, (SIZE_T)info.size);
+      CloseHandle(mapping); // the view keeps the mapping alive
+
+      return mapped != NULL;
+    }
+
+    /**
+     * The contents of a mapped file.
+     * 
+     * @returns The first byte, nullptr if the file isn't mapped
+    */
+    const char* mappedData() const {
+      return (const char*)mapped;
+    }
+
+    /**
+     * Looks up a file. Windows only hands out file indexes for open files, so this opens it briefly.
+     * 
+     * @returns true - The file exists
+    */
+    static bool stat(const std::string& path, LGFileInfo& info) {
+      LGFile* file = open(path);
+      if (file == nullptr) return false;
+
+      info = file->info;
+      delete file;
+
+      return true;
+    }
+
+    /**
+     * Opens a regular file for reading.
+     * 
+     * @returns The file, nullptr if it does not exist or isn't a regular file
+    */
+    static LGFile* open(const std::string& path) {
+      HANDLE handle = CreateFileA(path.c_str(), GENERIC_READ, FILE_SHARE_READ | FILE_SHARE_WRITE | FILE_SHARE_DELETE,
+        NULL, OPEN_EXISTING, FILE_FLAG_BACKUP_SEMANTICS, NULL);
+
+      if (handle == INVALID_HANDLE_VALUE) return nullptr;
+
+      BY_HANDLE_FILE_INFORMATION data;
+      LGFileInfo info;
+
+      if (!GetFileInformationByHandle(handle, &data)) {
+        CloseHandle(handle);
+        return nullptr;
+      }
+
+      fill(data, info);
+
+      if (!info.regular) {
+        CloseHandle(handle);
+        return nullptr;
+      }
+
+      return new LGFile(handle, info);
+    }
+  };
+
   /**
    * Wrapper class for client sockets. Allows for easy and similar use of sockets between platforms.
   */
@@ -46,14 +194,107 @@ namespace LandingGear {
       return socket != INVALID_SOCKET;
     }
 
+    SOCKET getSocket() const {
+      return socket;
+    }
+
+    /**
+     * Puts the socket in non-blocking mode.
+     * 
+     * @returns 1 - Error, 0 - Success
+    */
+    int setNonBlocking() {
+      u_long mode = 1;
+
+      if (ioctlsocket(socket, FIONBIO, &mode) != 0) {
+        std::cerr << "Could not make socket non-blocking! Error: " << WSAGetLastError() << std::endl;
+        return 1;
+      }
+
+      return 0;
+    }
+
+    /**
+     * Makes blocking receives fail once nothing arrived for the given time.
+     * 
+     * @returns 1 - Error, 0 - Success
+    */
+    int setReceiveTimeout(int milliseconds) {
+      DWORD timeout = milliseconds;
+
+      return setsockopt(socket, SOL_SOCKET, SO_RCVTIMEO, (const char*)&timeout, sizeof(timeout)) == SOCKET_ERROR ? 1 : 0;
+    }
+
+    /**
+     * Makes blocking sends fail once the client took nothing for the given time.
+     * 
+     * @returns 1 - Error, 0 - Success
+    */
+    int setSendTimeout(int milliseconds) {
+      DWORD timeout = milliseconds;
+
+      return setsockopt(socket, SOL_SOCKET, SO_SNDTIMEO, (const char*)&timeout, sizeof(timeout)) == SOCKET_ERROR ? 1 : 0;
+    }
+
+    /**
+     * Whether the last failed blocking receive/send failed because its timeout passed.
+    */
+    bool timedOut() const {
+      return WSAGetLastError() == WSAETIMEDOUT;
+    }
+
+    /**
+     * Whether the last failed receive/send only failed because a non-blocking socket was not ready.
+    */
+    bool wouldBlock() const {
+      return WSAGetLastError() == WSAEWOULDBLOCK;
+    }
+
     int receive(char* recvbuf, size_t recvbuflen, int flags = 0) {
       return recv(socket, recvbuf, recvbuflen, flags);
     }
 
-    int send(char* recvbuf, size_t recvbuflen, int flags = 0) {
+    int send(const char* recvbuf, size_t recvbuflen, int flags = 0) {
       return ::send(socket, recvbuf, recvbuflen, flags);
     }
 
+    /**
+     * Sends several buffers with one call. At most LG_MAX_SEND_BUFFERS are sent.
+     * 
+     * @returns The amount of bytes sent, which may end partway through a buffer. -1 on error
+    */
+    int sendv(const LGSendBuffer* buffers, size_t count) {
+      WSABUF vectors[LG_MAX_SEND_BUFFERS];
+      DWORD sent = 0;
+
+      if (count > LG_MAX_SEND_BUFFERS) count = LG_MAX_SEND_BUFFERS;
+
+      for (size_t i = 0; i < count; i++) {
+        vectors[i].buf = (CHAR*)buffers[i].data;
+        vectors[i].len = (ULONG)buffers[i].size;
+      }
+
+      if (WSASend(socket, vectors, (DWORD)count, &sent, 0, NULL, NULL) == SOCKET_ERROR) {
+        return -1;
+      }
+
+      return (int)sent;
+    }
+
+    /**
+     * Sends part of a file through a buffer.
+     * 
+     * @returns The amount of bytes sent, 0 if the file ended early. -1 on error
+    */
+    int sendFile(const LGFile& file, uint64_t offset, uint64_t length) {
+      char buffer[64 * 1024];
+      int bytes = file.readAt(buffer, length < sizeof(buffer) ? (size_t)length : sizeof(buffer), offset);
+
+      if (bytes <= 0) return bytes;
+
+      return send(buffer, bytes);
+    }
+
     /**
      * Closes the socket connection.
     */
@@ -65,12 +306,14 @@ namespace LandingGear {
 
   class LGServerSocket {
     private:
-    SOCKET socket;
+    SOCKET socket = INVALID_SOCKET;
     struct addrinfo* addr = NULL; // Address information of where to listen
     struct addrinfo hints;
+    int acceptError = 0; // WSAGetLastError of the last failed accept
 
     public:
     int port = 8080;
+    bool reusePort = false; // unused on Windows, the event loop mode is not available here
 
     LGServerSocket() {};
     LGServerSocket(int port): port(port) {};
@@ -85,14 +328,34 @@ namespace LandingGear {
       LGClientSocket csocket = LGClientSocket(clientSock);
 
       if (clientSock == INVALID_SOCKET) {
+        acceptError = WSAGetLastError();
         std::cerr << "Could not accept socket!" << std::endl;
-        close();
+
+        if (!outOfResources()) {
+          close();
+        }
         return LGClientSocket(INVALID_SOCKET);
       }
 
+      acceptError = 0;
       return csocket;
     }
 
+    /**
+     * Whether the last `accept` failed only because nothing was pending on a non-blocking socket.
+    */
+    bool wouldBlock() const {
+      return acceptError == WSAEWOULDBLOCK;
+    }
+
+    /**
+     * Whether the last `accept` failed because the process or system ran out of sockets or memory.
+     * The server socket is kept open, so accepting again later can succeed.
+    */
+    bool outOfResources() const {
+      return acceptError == WSAEMFILE || acceptError == WSAENOBUFS;
+    }
+
     /**
      * Close server socket connection.
     */
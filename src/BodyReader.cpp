@@ -0,0 +1,149 @@
+#include "BodyReader.h"
+#include "Scan.h"
+
+#include <algorithm>
+
+namespace LandingGear {
+
+  LGBodyReader::LGBodyReader(): maxLineLength(8192) {
+    reset();
+  };
+
+  /**
+   * @brief Prepares the reader for a request without a body. Keeps allocated storage around.
+   *
+   */
+  void LGBodyReader::reset() {
+    state = State::DONE;
+    remaining = 0;
+    errorCode = 0;
+    consumed = 0;
+    chunks.clear();
+  }
+
+  /**
+   * @brief Expects a body of exactly `length` bytes.
+   *
+   * @param length The Content-Length
+   */
+  void LGBodyReader::expectLength(uint64_t length) {
+    reset();
+
+    remaining = length;
+    state = length > 0 ? State::LENGTH : State::DONE;
+  }
+
+  /**
+   * @brief Expects a body with chunked transfer encoding.
+   *
+   */
+  void LGBodyReader::expectChunked() {
+    reset();
+
+    state = State::CHUNK_SIZE;
+  }
+
+  bool LGBodyReader::done() const {
+    return state == State::DONE;
+  }
+
+  LGBodyResult LGBodyReader::fail(int code) {
+    errorCode = code;
+    return LGBodyResult::ERROR;
+  }
+
+  /**
+   * @brief Parses "1a2b" or "1a2b;extension=value" into `remaining`.
+   *
+   * @return true - The line is valid
+   * @return false - The line is malformed or the size does not fit
+   */
+  bool LGBodyReader::parseChunkSize(const char* line, const char* lineEnd) {
+    uint64_t size = 0;
+    const char* c = line;
+
+    for (; c < lineEnd; c++) {
+      int digit;
+
+      if (*c >= '0' && *c <= '9') digit = *c - '0';
+      else if (*c >= 'a' && *c <= 'f') digit = *c - 'a' + 10;
+      else if (*c >= 'A' && *c <= 'F') digit = *c - 'A' + 10;
+      else break;
+
+      if (size >> 60) return false; // would overflow
+      size = (size << 4) | digit;
+    }
+
+    if (c == line) return false;
+
+    c = skipBlanks(c, lineEnd);
+    if (c != lineEnd && *c != ';') return false; // only extensions may follow, they are ignored
+
+    remaining = size;
+    return true;
+  }
+
+  /**
+   * @brief Continues decoding the body. `data` starts right after what the previous call consumed.
+   *
+   * @param data The receive buffer
+   * @param size The amount of bytes in the buffer
+   * @return LGBodyResult Whether the body is complete, incomplete or invalid
+   */
+  LGBodyResult LGBodyReader::decode(const char* data, size_t size) {
+    size_t position = 0;
+
+    consumed = 0;
+    chunks.clear();
+
+    if (errorCode != 0) return LGBodyResult::ERROR;
+
+    while (state != State::DONE) {
+      if (state == State::LENGTH || state == State::CHUNK_DATA) {
+        size_t amount = (size_t)std::min<uint64_t>(remaining, size - position);
+
+        if (amount > 0) {
+          chunks.push_back(std::string_view(data + position, amount));
+        }
+
+        position += amount;
+        remaining -= amount;
+
+        if (remaining > 0) break;
+
+        state = state == State::LENGTH ? State::DONE : State::CHUNK_DATA_END;
+        continue;
+      }
+
+      const char* newline = scanFor(data + position, data + size, '\n');
+
+      if (newline == data + size) {
+        if (size - position > maxLineLength) return fail(400);
+        break;
+      }
+
+      const char* line = data + position;
+      const char* lineEnd = newline;
+      if (lineEnd > line && lineEnd[-1] == '\r') lineEnd--;
+
+      if ((size_t)(lineEnd - line) > maxLineLength) return fail(400);
+
+      if (state == State::CHUNK_SIZE) {
+        if (!parseChunkSize(line, lineEnd)) return fail(400);
+        state = remaining > 0 ? State::CHUNK_DATA : State::TRAILERS;
+      } else if (state == State::CHUNK_DATA_END) {
+        if (lineEnd != line) return fail(400);
+        state = State::CHUNK_SIZE;
+      } else if (lineEnd == line) {
+        state = State::DONE; // the blank line after the trailers
+      }
+
+      position = newline - data + 1;
+    }
+
+    consumed = position;
+
+    return state == State::DONE ? LGBodyResult::COMPLETE : LGBodyResult::INCOMPLETE;
+  }
+
+}; // namespace LandingGear
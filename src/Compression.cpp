@@ -0,0 +1,330 @@
+#include "Compression.h"
+#include "LandingGear.h"
+
+#include <charconv>
+#include <mutex>
+#include <zlib.h>
+
+namespace LandingGear {
+
+  // Input handed to zlib per call, zlib counts in 32 bits
+  static const size_t DEFLATE_CHUNK = 256 * 1024;
+
+  /**
+   * @brief Compresses a body in one go. The output is sized from deflateBound up front,
+   * the input is streamed through zlib in chunks.
+   *
+   * @param body The body
+   * @param encoding GZIP or DEFLATE (the zlib format, as HTTP's "deflate" means)
+   * @param level The zlib level
+   * @return std::string The compressed body
+   */
+  std::string compressBody(std::string_view body, LGCompression encoding, int level) {
+    z_stream stream = {};
+    int windowBits = encoding == LGCompression::GZIP ? 15 + 16 : 15; // +16 writes a gzip header and trailer
+
+    if (deflateInit2(&stream, level, Z_DEFLATED, windowBits, 8, Z_DEFAULT_STRATEGY) != Z_OK) {
+      throw std::bad_alloc(); // the only way it fails with valid settings
+    }
+
+    std::string compressed;
+    compressed.resize(deflateBound(&stream, (uLong)body.size()));
+
+    size_t read = 0;
+    size_t written = 0;
+    int result = Z_OK;
+
+    while (result != Z_STREAM_END) {
+      if (stream.avail_in == 0 && read < body.size()) {
+        size_t chunk = std::min(body.size() - read, DEFLATE_CHUNK);
+
+        stream.next_in = (Bytef*)body.data() + read;
+        stream.avail_in = (uInt)chunk;
+        read += chunk;
+      }
+
+      if (written == compressed.size()) {
+        compressed.resize(compressed.size() * 2); // deflateBound should make this unreachable
+      }
+
+      stream.next_out = (Bytef*)&compressed[written];
+      stream.avail_out = (uInt)std::min(compressed.size() - written, DEFLATE_CHUNK);
+
+      uInt space = stream.avail_out;
+      result = deflate(&stream, read == body.size() ? Z_FINISH : Z_NO_FLUSH);
+      written += space - stream.avail_out;
+
+      if (result != Z_OK && result != Z_STREAM_END && result != Z_BUF_ERROR) {
+        deflateEnd(&stream);
+        throw std::bad_alloc();
+      }
+    }
+
+    deflateEnd(&stream);
+    compressed.resize(written);
+
+    return compressed;
+  }
+
+  /**
+   * @brief Compresses a streamed body as it is written. Data is held back until zlib has collected
+   * enough of it, or until the stream is flushed.
+   *
+   */
+  class LGDeflateStream : public LGStreamEncoder {
+    private:
+    z_stream stream;
+
+    std::string run(std::string_view data, int flush) {
+      std::string output;
+      size_t read = 0;
+      int result = Z_OK;
+
+      // zlib is done once it has taken all input and left room in the output, a finish only once the stream ended
+      do {
+        if (stream.avail_in == 0 && read < data.size()) {
+          size_t chunk = std::min(data.size() - read, DEFLATE_CHUNK);
+
+          stream.next_in = (Bytef*)data.data() + read;
+          stream.avail_in = (uInt)chunk;
+          read += chunk;
+        }
+
+        size_t written = output.size();
+        output.resize(written + std::max(deflateBound(&stream, stream.avail_in), (uLong)64));
+
+        stream.next_out = (Bytef*)&output[written];
+        stream.avail_out = (uInt)(output.size() - written);
+
+        result = deflate(&stream, read == data.size() ? flush : Z_NO_FLUSH);
+        output.resize(output.size() - stream.avail_out);
+
+        if (result != Z_OK && result != Z_STREAM_END && result != Z_BUF_ERROR) {
+          throw std::bad_alloc();
+        }
+      } while (result != Z_STREAM_END && (flush == Z_FINISH || stream.avail_in > 0 || read < data.size() || stream.avail_out == 0));
+
+      return output;
+    }
+
+    public:
+    LGDeflateStream(LGCompression encoding, int level): stream() {
+      int windowBits = encoding == LGCompression::GZIP ? 15 + 16 : 15;
+
+      if (deflateInit2(&stream, level, Z_DEFLATED, windowBits, 8, Z_DEFAULT_STRATEGY) != Z_OK) {
+        throw std::bad_alloc();
+      }
+    }
+
+    LGDeflateStream(const LGDeflateStream&) = delete;
+
+    ~LGDeflateStream() {
+      deflateEnd(&stream);
+    }
+
+    std::string encode(std::string_view data, bool flush) override {
+      return run(data, flush ? Z_SYNC_FLUSH : Z_NO_FLUSH);
+    }
+
+    std::string finish() override {
+      return run(std::string_view(), Z_FINISH);
+    }
+  };
+
+  // Whether a comma separated header value (eg. Vary or Cache-Control) contains a token
+  static bool listIncludes(std::string_view list, std::string_view token) {
+    while (!list.empty()) {
+      size_t end = list.find(',');
+      std::string_view item = list.substr(0, end);
+      list = end == std::string_view::npos ? std::string_view() : list.substr(end + 1);
+
+      while (!item.empty() && item.front() == ' ') item.remove_prefix(1);
+      while (!item.empty() && item.back() == ' ') item.remove_suffix(1);
+
+      if (equalsIgnoreCase(item, token)) return true;
+    }
+
+    return false;
+  }
+
+  /**
+   * @brief Whether a content type is worth compressing: text, JSON, JavaScript and XML.
+   *
+   * @param type The Content-Type header, empty for the default text/plain
+   */
+  static bool compressibleType(std::string_view type) {
+    type = type.substr(0, type.find(';'));
+
+    while (!type.empty() && type.back() == ' ') type.remove_suffix(1);
+
+    if (type.empty() || (type.size() > 5 && equalsIgnoreCase(type.substr(0, 5), "text/"))) return true;
+
+    static const std::string_view suffixes[] = {"/json", "+json", "/javascript", "/xml", "+xml"};
+
+    for (std::string_view suffix : suffixes) {
+      if (type.size() > suffix.size() && equalsIgnoreCase(type.substr(type.size() - suffix.size()), suffix)) return true;
+    }
+
+    return false;
+  }
+
+  // Caches must keep the compressed and the original body apart
+  static void varyOnEncoding(LGResponse& res) {
+    std::string_view vary = res.headers[LGHeaderId::VARY];
+
+    if (vary.empty()) {
+      res.headers.setHeader("Vary", "Accept-Encoding");
+    } else if (!listIncludes(vary, "*") && !listIncludes(vary, "accept-encoding")) {
+      res.headers.setHeader("Vary", std::string(vary) + ", Accept-Encoding");
+    }
+  }
+
+  /**
+   * @brief Decides whether a response is compressed and sets its headers for it.
+   *
+   * @param size Bytes of the body, UINT64_MAX for a stream of unknown length
+   * @return true - The body is to be compressed
+   */
+  static bool encodeResponse(const LGCompressionOptions& options, LGCompression encoding, LGResponse& res, uint64_t size) {
+    if (res.statusCode == 206 || res.headers.hasHeader(LGHeaderId::CONTENT_ENCODING)
+      || listIncludes(res.headers[LGHeaderId::CACHE_CONTROL], "no-transform")
+      || !compressibleType(res.headers[LGHeaderId::CONTENT_TYPE])) {
+      return false;
+    }
+
+    varyOnEncoding(res);
+
+    if (encoding == LGCompression::NONE || size < options.threshold) {
+      return false;
+    }
+
+    res.headers.setHeader("Content-Encoding", encoding == LGCompression::GZIP ? "gzip" : "deflate");
+    res.headers.removeHeader("Content-Length");
+
+    // The compressed body is a different representation, only a weak validator still fits it
+    std::string_view etag = res.headers[LGHeaderId::ETAG];
+
+    if (!etag.empty() && etag.substr(0, 2) != "W/") {
+      res.headers.setHeader("ETag", "W/" + std::string(etag));
+    }
+
+    return true;
+  }
+
+  /**
+   * @brief What a `compress` middleware shares between requests. Its pool is started with the first offloaded body.
+   *
+   */
+  struct LGCompressionState {
+    LGCompressionOptions options;
+    std::once_flag poolStarted;
+
+    LGWorkerPool& pool() {
+      std::call_once(poolStarted, [this]() {
+        if (!options.pool) {
+          options.pool = std::make_shared<LGWorkerPool>();
+          options.pool->start(options.threads);
+        }
+      });
+
+      return *options.pool;
+    }
+  };
+
+  /**
+   * @brief The body filter `compress` installs. Compresses on the pool when the body is large enough
+   * and the server runs event loops, `sendDeferred` would compress right away otherwise.
+   *
+   */
+  static bool compressResponse(LGCompressionState& state, LGCompression encoding, LGResponse& res, std::string& body) {
+    const LGCompressionOptions& options = state.options;
+
+    if (!encodeResponse(options, encoding, res, body.size())) {
+      return false;
+    }
+
+#ifdef LG_HAS_EPOLL
+    if (options.offloadSize > 0 && body.size() >= options.offloadSize && res.app != nullptr && res.app->mode == LGServerMode::EVENT_LOOP) {
+      res.sendDeferred(state.pool(), [body = std::move(body), encoding, level = options.level]() {
+        return compressBody(body, encoding, level);
+      });
+
+      return true;
+    }
+#endif
+
+    body = compressBody(body, encoding, options.level);
+
+    return false;
+  }
+
+  /**
+   * @brief The stream filter `compress` installs. A stream is compressed unless its Content-Length is below the threshold,
+   * the compressed body is then chunked.
+   *
+   */
+  static std::unique_ptr<LGStreamEncoder> compressStream(const LGCompressionOptions& options, LGCompression encoding, LGResponse& res) {
+    uint64_t size = UINT64_MAX;
+    std::string_view length = res.headers[LGHeaderId::CONTENT_LENGTH];
+
+    if (!length.empty()) {
+      std::from_chars(length.data(), length.data() + length.size(), size);
+    }
+
+    if (!encodeResponse(options, encoding, res, size)) {
+      return nullptr;
+    }
+
+    return std::unique_ptr<LGStreamEncoder>(new LGDeflateStream(encoding, options.level));
+  }
+
+  LGMiddlewareCB compress() {
+    return compress(LGCompressionOptions());
+  }
+
+  /**
+   * @brief Compresses bodies sent with `send` and `end` for clients that accept gzip or deflate,
+   * preferring gzip. Only text, JSON, JavaScript and XML bodies of at least `threshold` bytes are
+   * compressed, and never HEAD responses, responses that already have a Content-Encoding or ones
+   * marked no-transform. Files from `getStatic` are sent as they are, use precompressed files for those.
+   *
+   * Streamed responses (`write`) are compressed as they are written unless a Content-Length below
+   * `threshold` was set. zlib holds data back until it collected enough, `flush` sends what it has.
+   *
+   * With event loops, large bodies are compressed on a separate pool while the loop goes on with
+   * other connections. Later responses on the same connection are written once the body is done.
+   *
+   * @param options Settings for the level, threshold and pool
+   * @return LGMiddlewareCB The middleware, use it with `app.use` before the routes it should cover
+   */
+  LGMiddlewareCB compress(LGCompressionOptions options) {
+    std::shared_ptr<LGCompressionState> settings = std::make_shared<LGCompressionState>();
+    settings->options = std::move(options);
+
+    return [settings](LGRequest& req, LGResponse& res, NextFunction next) {
+      if (req.methodId != LGMethod::HTTP_HEAD) {
+        LGCompressionState* state = settings.get(); // kept alive by the middleware, small enough to not allocate per request
+        LGCompression encoding = LGCompression::NONE;
+
+        std::string_view accepted = req.headers[LGHeaderId::ACCEPT_ENCODING];
+
+        if (acceptsEncoding(accepted, "gzip")) {
+          encoding = LGCompression::GZIP;
+        } else if (acceptsEncoding(accepted, "deflate")) {
+          encoding = LGCompression::DEFLATE;
+        }
+
+        res.bodyFilter = [state, encoding](LGResponse& res, std::string& body) {
+          return compressResponse(*state, encoding, res, body);
+        };
+
+        res.streamFilter = [state, encoding](LGResponse& res) {
+          return compressStream(state->options, encoding, res);
+        };
+      }
+
+      next();
+    };
+  }
+
+}; // namespace LandingGear
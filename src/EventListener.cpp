@@ -42,11 +42,29 @@ namespace LandingGear {
    * @param data The data to be sent
    */
   void EventListener::emit(std::string event, EventData data) {
-    for (auto cb : events[event]) {
+    auto listeners = events.find(event); // don't create an entry for events nobody listens to
+
+    if (listeners == events.end()) {
+      return;
+    }
+
+    for (auto cb : listeners->second) {
       cb(data);
     }
   }
 
+  /**
+   * @brief Counts the listeners of an event. Lets callers skip building event data nobody receives.
+   * 
+   * @param event The event type
+   * @return size_t The amount of listeners
+   */
+  size_t EventListener::listenerCount(const std::string& event) const {
+    auto listeners = events.find(event);
+
+    return listeners == events.end() ? 0 : listeners->second.size();
+  }
+
   /**
    * @brief Turns off a listener or stops listening to an event.
    * 
@@ -79,7 +97,7 @@ namespace LandingGear {
    * @param cb The listener cb that gets called when event is emitted.
    */
   void EventListener::once(std::string event, EventCallback cb) {
-    EventCallback cb2 = [=](EventData e) {
+    EventCallback cb2 = [=, this](EventData e) {
       cb(e);
 
       off(event, cb2);
@@ -0,0 +1,179 @@
+#include "EventLoop.h"
+
+#ifdef LG_HAS_EPOLL
+
+#include <cerrno>
+#include <chrono>
+#include <iostream>
+#include <sys/epoll.h>
+#include <sys/eventfd.h>
+#include <unistd.h>
+
+namespace LandingGear {
+
+  LGEventLoop::LGEventLoop(): epollFd(-1), wakeFd(-1), running(false) {};
+
+  LGEventLoop::~LGEventLoop() {
+    if (wakeFd >= 0) ::close(wakeFd);
+    if (epollFd >= 0) ::close(epollFd);
+  }
+
+  /**
+   * @brief Creates the epoll instance and the wakeup eventfd.
+   *
+   * @return int 1 - Error, 0 - Success
+   */
+  int LGEventLoop::init() {
+    epollFd = epoll_create1(EPOLL_CLOEXEC);
+
+    if (epollFd < 0) {
+      std::cerr << "Failed to create epoll instance!" << std::endl;
+      return 1;
+    }
+
+    wakeFd = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+
+    if (wakeFd < 0) {
+      std::cerr << "Failed to create eventfd!" << std::endl;
+      return 1;
+    }
+
+    struct epoll_event event = {};
+    event.events = EPOLLIN;
+    event.data.ptr = nullptr; // a null pollable marks the wakeup fd
+
+    return epoll_ctl(epollFd, EPOLL_CTL_ADD, wakeFd, &event) < 0 ? 1 : 0;
+  }
+
+  /**
+   * @brief Registers an fd for edge-triggered readiness. Hangups are always reported.
+   *
+   * @param fd The file descriptor
+   * @param pollable The object notified when the fd becomes ready
+   * @param events The LGPollEvent flags to wait for, read and write by default
+   * @return int 1 - Error, 0 - Success
+   */
+  int LGEventLoop::add(int fd, LGPollable* pollable, int events) {
+    struct epoll_event event = {};
+    event.events = EPOLLRDHUP | EPOLLET;
+    if (events & LG_POLL_READ) event.events |= EPOLLIN;
+    if (events & LG_POLL_WRITE) event.events |= EPOLLOUT;
+    event.data.ptr = pollable;
+
+    if (epoll_ctl(epollFd, EPOLL_CTL_ADD, fd, &event) < 0) {
+      std::cerr << "Failed to add fd to epoll!" << std::endl;
+      return 1;
+    }
+
+    return 0;
+  }
+
+  /**
+   * @brief Unregisters an fd. Must be called before the fd is closed.
+   *
+   * @param fd The file descriptor
+   * @return int 1 - Error, 0 - Success
+   */
+  int LGEventLoop::remove(int fd) {
+    return epoll_ctl(epollFd, EPOLL_CTL_DEL, fd, nullptr) < 0 ? 1 : 0;
+  }
+
+  /**
+   * @brief Queues a job to run on the loop thread. Safe to call from any thread.
+   *
+   * @param job The job to run
+   */
+  void LGEventLoop::post(std::function<void(void)> job) {
+    {
+      std::lock_guard<std::mutex> guard(postLock);
+      posted.push_back(std::move(job));
+    }
+
+    uint64_t one = 1;
+    ssize_t written = ::write(wakeFd, &one, sizeof(one));
+    (void)written;
+  }
+
+  void LGEventLoop::runPosted() {
+    uint64_t count;
+    while (::read(wakeFd, &count, sizeof(count)) > 0);
+
+    std::vector<std::function<void(void)>> jobs;
+
+    {
+      std::lock_guard<std::mutex> guard(postLock);
+      jobs.swap(posted);
+    }
+
+    for (auto& job : jobs) {
+      job();
+    }
+  }
+
+  /**
+   * @brief Runs a timer's callback on the loop thread once the time passed, replacing its previous schedule.
+   * Cancel it with `LGTimer::cancel`. Only called from the loop thread.
+   *
+   * @param timer The timer
+   * @param milliseconds Time until it expires
+   */
+  void LGEventLoop::schedule(LGTimer& timer, int milliseconds) {
+    timers.schedule(timer, milliseconds);
+  }
+
+  /**
+   * @brief Runs the loop on the calling thread until `stop` is called.
+   *
+   */
+  void LGEventLoop::run() {
+    struct epoll_event events[256];
+    running = true;
+
+    while (running) {
+      int count = epoll_wait(epollFd, events, 256, LG_TIMER_TICK_MS);
+
+      if (count < 0) {
+        if (errno == EINTR) continue;
+
+        std::cerr << "epoll_wait failed!" << std::endl;
+        break;
+      }
+
+      bool wakeup = false;
+
+      for (int i = 0; i < count; i++) {
+        LGPollable* pollable = (LGPollable*)events[i].data.ptr;
+
+        if (pollable == nullptr) {
+          wakeup = true;
+          continue;
+        }
+
+        int flags = 0;
+        if (events[i].events & EPOLLIN) flags |= LG_POLL_READ;
+        if (events[i].events & EPOLLOUT) flags |= LG_POLL_WRITE;
+        if (events[i].events & (EPOLLHUP | EPOLLERR | EPOLLRDHUP)) flags |= LG_POLL_HANGUP;
+
+        pollable->onEvent(flags);
+      }
+
+      // Posted jobs run after the batch, a job that deletes an object can't leave a stale event for it behind
+      if (wakeup) {
+        runPosted();
+      }
+
+      timers.advance(std::chrono::steady_clock::now());
+    }
+  }
+
+  /**
+   * @brief Stops the loop after the current iteration. Safe to call from any thread.
+   *
+   */
+  void LGEventLoop::stop() {
+    post([this]() { running = false; });
+  }
+
+}; // namespace LandingGear
+
+#endif
@@ -0,0 +1,99 @@
+#include "HeaderNames.h"
+
+#include <cstdint>
+
+namespace LandingGear {
+
+  // In the order of LGHeaderId, with the casing used when they are written out
+  static constexpr std::string_view headerNames[] = {
+    "Host", "Connection", "Content-Length", "Content-Type", "Transfer-Encoding", "Accept", "Accept-Encoding",
+    "Accept-Language", "User-Agent", "Cookie", "Set-Cookie", "Authorization", "Cache-Control", "ETag",
+    "Last-Modified", "If-None-Match", "If-Modified-Since", "If-Range", "Range", "Expect", "Upgrade", "Origin",
+    "Referer", "Vary", "Content-Encoding", "Content-Range", "Accept-Ranges", "Location", "Date", "Keep-Alive",
+    "Allow", "X-Forwarded-For", "Content-Disposition", "Server", "TE", "Trailer",
+  };
+
+  static_assert(sizeof(headerNames) / sizeof(headerNames[0]) == LG_HEADER_COUNT, "every header id needs a name");
+
+  static const size_t HEADER_SLOTS = 128;
+
+  static constexpr char foldCase(char c) {
+    return c >= 'A' && c <= 'Z' ? c + ('a' - 'A') : c;
+  }
+
+  // The length, first and last character are enough to tell the known names apart, see the static_assert below
+  static constexpr size_t headerSlot(std::string_view name) {
+    return (name.size() + 4 * (unsigned char)foldCase(name.front()) + 24 * (unsigned char)foldCase(name.back())) % HEADER_SLOTS;
+  }
+
+  struct HeaderTable {
+    uint8_t slots[HEADER_SLOTS]; // the id + 1 of the name hashed to each slot, 0 for none
+  };
+
+  static constexpr HeaderTable buildHeaderTable() {
+    HeaderTable table = {};
+
+    for (size_t i = 0; i < LG_HEADER_COUNT; i++) {
+      table.slots[headerSlot(headerNames[i])] = (uint8_t)(i + 1);
+    }
+
+    return table;
+  }
+
+  static constexpr HeaderTable headerTable = buildHeaderTable();
+
+  static constexpr bool isPerfect() {
+    for (size_t i = 0; i < LG_HEADER_COUNT; i++) {
+      if (headerTable.slots[headerSlot(headerNames[i])] != i + 1) return false;
+    }
+
+    return true;
+  }
+
+  static_assert(isPerfect(), "two known header names hash to the same slot");
+
+  /**
+   * @brief Compares two strings ignoring ASCII case, without copying either.
+   *
+   * @return true - The strings are equal
+   * @return false - The strings differ
+   */
+  bool equalsIgnoreCase(std::string_view a, std::string_view b) {
+    if (a.size() != b.size()) return false;
+
+    for (size_t i = 0; i < a.size(); i++) {
+      if (foldCase(a[i]) != foldCase(b[i])) return false;
+    }
+
+    return true;
+  }
+
+  /**
+   * @brief Converts a header name to its id. Header names are case-insensitive.
+   *
+   * @param name The name (eg. "content-type")
+   * @return LGHeaderId The id, UNKNOWN if it isn't a well-known header
+   */
+  LGHeaderId headerId(std::string_view name) {
+    if (name.empty()) return LGHeaderId::UNKNOWN;
+
+    uint8_t slot = headerTable.slots[headerSlot(name)];
+
+    if (slot == 0 || !equalsIgnoreCase(name, headerNames[slot - 1])) {
+      return LGHeaderId::UNKNOWN;
+    }
+
+    return (LGHeaderId)(slot - 1);
+  }
+
+  /**
+   * @brief Converts a header id to its name.
+   *
+   * @param id The id
+   * @return std::string_view The name (eg. "Content-Type"), empty for UNKNOWN
+   */
+  std::string_view headerName(LGHeaderId id) {
+    return id == LGHeaderId::UNKNOWN ? std::string_view() : headerNames[(size_t)id];
+  }
+
+}; // namespace LandingGear
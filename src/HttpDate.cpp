@@ -0,0 +1,116 @@
+#include "HttpDate.h"
+
+namespace LandingGear {
+
+  static const char* dayNames[] = {"Thu", "Fri", "Sat", "Sun", "Mon", "Tue", "Wed"}; // 1970-01-01 was a Thursday
+  static const char* monthNames[] = {"Jan", "Feb", "Mar", "Apr", "May", "Jun", "Jul", "Aug", "Sep", "Oct", "Nov", "Dec"};
+
+  // Days since the epoch of a date in the proleptic Gregorian calendar. Avoids timegm, which Windows lacks.
+  static int64_t daysFromCivil(int64_t year, unsigned month, unsigned day) {
+    year -= month <= 2;
+
+    int64_t era = (year >= 0 ? year : year - 399) / 400;
+    unsigned yearOfEra = (unsigned)(year - era * 400);
+    unsigned dayOfYear = (153 * (month + (month > 2 ? -3 : 9)) + 2) / 5 + day - 1;
+    unsigned dayOfEra = yearOfEra * 365 + yearOfEra / 4 - yearOfEra / 100 + dayOfYear;
+
+    return era * 146097 + (int64_t)dayOfEra - 719468;
+  }
+
+  // The date of a day since the epoch, the inverse of daysFromCivil.
+  static void civilFromDays(int64_t days, int64_t& year, unsigned& month, unsigned& day) {
+    days += 719468;
+
+    int64_t era = (days >= 0 ? days : days - 146096) / 146097;
+    unsigned dayOfEra = (unsigned)(days - era * 146097);
+    unsigned yearOfEra = (dayOfEra - dayOfEra / 1460 + dayOfEra / 36524 - dayOfEra / 146096) / 365;
+    unsigned dayOfYear = dayOfEra - (365 * yearOfEra + yearOfEra / 4 - yearOfEra / 100);
+    unsigned monthPart = (5 * dayOfYear + 2) / 153;
+
+    day = dayOfYear - (153 * monthPart + 2) / 5 + 1;
+    month = monthPart < 10 ? monthPart + 3 : monthPart - 9;
+    year = (int64_t)yearOfEra + era * 400 + (month <= 2);
+  }
+
+  static void appendPadded(std::string& out, int64_t value, int width) {
+    char digits[24];
+    int length = 0;
+
+    do {
+      digits[length++] = '0' + value % 10;
+      value /= 10;
+    } while (value > 0 || length < width);
+
+    while (length > 0) out += digits[--length];
+  }
+
+  std::string formatHttpDate(int64_t seconds) {
+    int64_t days = seconds >= 0 ? seconds / 86400 : (seconds - 86399) / 86400;
+    int64_t secondOfDay = seconds - days * 86400;
+
+    int64_t year;
+    unsigned month, day;
+    civilFromDays(days, year, month, day);
+
+    std::string date;
+    date.reserve(29);
+
+    date += dayNames[((days % 7) + 7) % 7];
+    date += ", ";
+    appendPadded(date, day, 2);
+    date += ' ';
+    date += monthNames[month - 1];
+    date += ' ';
+    appendPadded(date, year, 4);
+    date += ' ';
+    appendPadded(date, secondOfDay / 3600, 2);
+    date += ':';
+    appendPadded(date, secondOfDay / 60 % 60, 2);
+    date += ':';
+    appendPadded(date, secondOfDay % 60, 2);
+    date += " GMT";
+
+    return date;
+  }
+
+  static bool parseNumber(std::string_view text, size_t position, size_t length, int64_t& value) {
+    value = 0;
+
+    for (size_t i = position; i < position + length; i++) {
+      if (text[i] < '0' || text[i] > '9') return false;
+      value = value * 10 + (text[i] - '0');
+    }
+
+    return true;
+  }
+
+  bool parseHttpDate(std::string_view text, int64_t& seconds) {
+    // "Sun, 06 Nov 1994 08:49:37 GMT"
+    if (text.size() != 29 || text[3] != ',' || text[4] != ' ' || text[7] != ' ' || text[11] != ' ' || text[16] != ' '
+      || text[19] != ':' || text[22] != ':' || text.substr(25) != " GMT") {
+      return false;
+    }
+
+    int64_t day, year, hour, minute, second;
+
+    if (!parseNumber(text, 5, 2, day) || !parseNumber(text, 12, 4, year) || !parseNumber(text, 17, 2, hour)
+      || !parseNumber(text, 20, 2, minute) || !parseNumber(text, 23, 2, second)) {
+      return false;
+    }
+
+    unsigned month = 0;
+
+    for (unsigned i = 0; i < 12; i++) {
+      if (text.substr(8, 3) == monthNames[i]) month = i + 1;
+    }
+
+    if (month == 0 || day < 1 || day > 31 || hour > 23 || minute > 59 || second > 60) {
+      return false;
+    }
+
+    seconds = daysFromCivil(year, month, (unsigned)day) * 86400 + hour * 3600 + minute * 60 + second;
+
+    return true;
+  }
+
+}; // namespace LandingGear
@@ -1,77 +1,152 @@
 #include "LandingGear.h"
+#include "HttpDate.h"
+
+#include <charconv>
 
 namespace LandingGear {
 
-  // A list of all available HTTP status codes.
-  static std::unordered_map<int, std::string> statusCodes = {
+  // A status line per status code, pre-rendered so responses start with a single append
+  #define LG_STATUS(code, reason) {code, "HTTP/1.1 " #code " " reason "\r\n"}
+
+  static constexpr struct {
+    int code;
+    std::string_view line; // eg. "HTTP/1.1 200 OK\r\n"
+  } statusLines[] = {
+    // 100 Codes
+    LG_STATUS(100, "Continue"),
+    LG_STATUS(101, "Switching Protocols"),
+    LG_STATUS(102, "Processing"),
+    LG_STATUS(103, "Early Hints"),
+
     // 200 Codes
-    {200, "OK"},
-    {201, "Created"},
-    {202, "Accepted"},
-    {203, "Non-Authoritative Information"},
-    {204, "No Content"},
-    {205, "Reset Content"},
-    {206, "Partial Content"},
-    {207, "Multi-Status"},
-    {208, "Already Reported"},
-    {226, "IM Used"},
+    LG_STATUS(200, "OK"),
+    LG_STATUS(201, "Created"),
+    LG_STATUS(202, "Accepted"),
+    LG_STATUS(203, "Non-Authoritative Information"),
+    LG_STATUS(204, "No Content"),
+    LG_STATUS(205, "Reset Content"),
+    LG_STATUS(206, "Partial Content"),
+    LG_STATUS(207, "Multi-Status"),
+    LG_STATUS(208, "Already Reported"),
+    LG_STATUS(226, "IM Used"),
 
     // 300 Codes
-    {300, "Multiple Choices"},
-    {301, "Moved Permanently"},
-    {302, "Found"},
-    {303, "See Other"},
-    {304, "Not Modified"},
-    {305, "Use Proxy"},
-    {306, "unused"},
-    {307, "Temporary Redirect"},
-    {308, "Permanent Redirect"},
-
-    // 400 Codes,
-    {400, "Bad Request"},
-    {401, "Unauthorized"},
-    {402, "Payment Required"},
-    {403, "Forbidden"},
-    {404, "Not Found"},
-    {405, "Method Not Allowed"},
-    {406, "Not Acceptable"},
-    {407, "Proxy Authentication Required"},
-    {408, "Request Timeout"},
-    {409, "Conflict"},
-    {410, "Gone"},
-    {411, "Length Required"},
-    {412, "Precondition Failed"},
-    {413, "Payload Too Large"},
-    {414, "URI Too Long"},
-    {415, "Unsupported Media Type"},
-    {416, "Range Not Satisfiable"},
-    {417, "Expectation Failed"},
-    {418, "I'm a teapot"},
-    {421, "Misdirected Request"},
-    {422, "Unprocessable Entity"},
-    {423, "Locked"},
-    {424, "Failed Dependency"},
-    {425, "Too Early"},
-    {426, "Upgrade Required"},
-    {428, "Precondition Required"},
-    {429, "Too Many Requests"},
-    {431, "Request Header Fields Too Large"},
-    {451, "Unavailable For Legal Reasons"},
-
-    // 500 Codes,
-    {500, "Internal Server Error"},
-    {501, "Not Implemented"},
-    {502, "Bad Gateway"},
-    {503, "Service Unavailable"},
-    {504, "Gateway Timeout"},
-    {505, "HTTP Version Not Supported"},
-    {506, "Variant Also Negotiates"},
-    {507, "Insufficient Storage"},
-    {508, "Loop Detected"},
-    {510, "Not Extended"},
-    {511, "Network Authentication Required"},
+    LG_STATUS(300, "Multiple Choices"),
+    LG_STATUS(301, "Moved Permanently"),
+    LG_STATUS(302, "Found"),
+    LG_STATUS(303, "See Other"),
+    LG_STATUS(304, "Not Modified"),
+    LG_STATUS(305, "Use Proxy"),
+    LG_STATUS(306, "unused"),
+    LG_STATUS(307, "Temporary Redirect"),
+    LG_STATUS(308, "Permanent Redirect"),
+
+    // 400 Codes
+    LG_STATUS(400, "Bad Request"),
+    LG_STATUS(401, "Unauthorized"),
+    LG_STATUS(402, "Payment Required"),
+    LG_STATUS(403, "Forbidden"),
+    LG_STATUS(404, "Not Found"),
+    LG_STATUS(405, "Method Not Allowed"),
+    LG_STATUS(406, "Not Acceptable"),
+    LG_STATUS(407, "Proxy Authentication Required"),
+    LG_STATUS(408, "Request Timeout"),
+    LG_STATUS(409, "Conflict"),
+    LG_STATUS(410, "Gone"),
+    LG_STATUS(411, "Length Required"),
+    LG_STATUS(412, "Precondition Failed"),
+    LG_STATUS(413, "Payload Too Large"),
+    LG_STATUS(414, "URI Too Long"),
+    LG_STATUS(415, "Unsupported Media Type"),
+    LG_STATUS(416, "Range Not Satisfiable"),
+    LG_STATUS(417, "Expectation Failed"),
+    LG_STATUS(418, "I'm a teapot"),
+    LG_STATUS(421, "Misdirected Request"),
+    LG_STATUS(422, "Unprocessable Entity"),
+    LG_STATUS(423, "Locked"),
+    LG_STATUS(424, "Failed Dependency"),
+    LG_STATUS(425, "Too Early"),
+    LG_STATUS(426, "Upgrade Required"),
+    LG_STATUS(428, "Precondition Required"),
+    LG_STATUS(429, "Too Many Requests"),
+    LG_STATUS(431, "Request Header Fields Too Large"),
+    LG_STATUS(451, "Unavailable For Legal Reasons"),
+
+    // 500 Codes
+    LG_STATUS(500, "Internal Server Error"),
+    LG_STATUS(501, "Not Implemented"),
+    LG_STATUS(502, "Bad Gateway"),
+    LG_STATUS(503, "Service Unavailable"),
+    LG_STATUS(504, "Gateway Timeout"),
+    LG_STATUS(505, "HTTP Version Not Supported"),
+    LG_STATUS(506, "Variant Also Negotiates"),
+    LG_STATUS(507, "Insufficient Storage"),
+    LG_STATUS(508, "Loop Detected"),
+    LG_STATUS(510, "Not Extended"),
+    LG_STATUS(511, "Network Authentication Required"),
+  };
+
+  #undef LG_STATUS
+
+  static const int FIRST_STATUS = 100;
+  static const int LAST_STATUS = 599;
+
+  struct StatusIndex {
+    uint8_t entries[LAST_STATUS - FIRST_STATUS + 1]; // the position + 1 in statusLines of each code, 0 for unknown codes
   };
 
+  static constexpr StatusIndex buildStatusIndex() {
+    StatusIndex index = {};
+
+    for (size_t i = 0; i < sizeof(statusLines) / sizeof(statusLines[0]); i++) {
+      index.entries[statusLines[i].code - FIRST_STATUS] = (uint8_t)(i + 1);
+    }
+
+    return index;
+  }
+
+  static constexpr StatusIndex statusIndex = buildStatusIndex();
+
+  // The pre-rendered status line of a code, empty if the code isn't known
+  static std::string_view statusLine(int code) {
+    if (code < FIRST_STATUS || code > LAST_STATUS || statusIndex.entries[code - FIRST_STATUS] == 0) {
+      return std::string_view();
+    }
+
+    return statusLines[statusIndex.entries[code - FIRST_STATUS] - 1].line;
+  }
+
+  // The reason phrase of a code (eg. "Not Found"), empty if the code isn't known
+  static std::string_view statusReason(int code) {
+    std::string_view line = statusLine(code);
+
+    return line.empty() ? line : line.substr(13, line.size() - 15); // after "HTTP/1.1 200 ", before "\r\n"
+  }
+
+  // Pipelined responses are written out once this much output has been collected.
+  static const size_t PIPELINE_FLUSH_SIZE = 64 * 1024;
+
+  // Queued buffers up to this size are copied onto the previous one instead of taking an iovec of their own,
+  // as long as the previous one stays under OUTPUT_COALESCE_LIMIT. Large bodies are never grown.
+  static const size_t OUTPUT_COALESCE_SIZE = 1024;
+  static const size_t OUTPUT_COALESCE_LIMIT = 16 * 1024;
+
+  // Bytes each connection keeps for the strings and maps of its current request before the arena grows
+  static const size_t REQUEST_ARENA_SIZE = 8 * 1024;
+
+  // LGRequest::heldBy while no middleware is continuing asynchronously
+  static const size_t NO_HOLDER = (size_t)-1;
+
+  // Most bytes handed to one gathered send, sends report their progress as an int. Mapped files can be far larger.
+  static const size_t OUTPUT_GATHER_LIMIT = 1 << 30;
+
+  // Bytes a connection buffers beyond the largest head it accepts before it stops reading,
+  // until a request or response it waits on makes room
+  static const size_t INPUT_BODY_ALLOWANCE = 64 * 1024;
+
+  // How long accepting pauses after the process ran out of descriptors, the pending connections wait in the backlog
+  static const int ACCEPT_RETRY_MS = 100;
+
   // trim from start (in place)
   static inline void ltrim(std::string &s) {
       s.erase(s.begin(), std::find_if(s.begin(), s.end(), [](unsigned char ch) {
@@ -137,7 +212,7 @@ namespace LandingGear {
     return splitted;
   }
 
-  bool endsWith(const std::string &mainStr, const std::string &toMatch)
+  bool endsWith(std::string_view mainStr, std::string_view toMatch)
   {
     if (mainStr.size() >= toMatch.size() &&
       mainStr.compare(mainStr.size() - toMatch.size(), toMatch.size(), toMatch) == 0)
@@ -146,21 +221,152 @@ namespace LandingGear {
       return false;
   }
 
-  bool startsWith(const std::string &mainStr, const std::string &toMatch)
+  bool startsWith(std::string_view mainStr, std::string_view toMatch)
   {
     return mainStr.rfind(toMatch, 0) == 0;
   }
 
-  bool includes(const std::string &str, const std::string &toMatch) {
-    return str.find(toMatch) != std::string::npos;
+  bool includes(std::string_view str, std::string_view toMatch) {
+    return str.find(toMatch) != std::string_view::npos;
+  }
+
+  static bool includesIgnoreCase(std::string_view str, std::string_view toMatch) {
+    for (size_t i = 0; i + toMatch.size() <= str.size(); i++) {
+      if (equalsIgnoreCase(str.substr(i, toMatch.size()), toMatch)) return true;
+    }
+
+    return false;
+  }
+
+  // Headers most requests and responses stay under, reserved on the first one so the list rarely grows
+  static const size_t HEADER_RESERVE = 16;
+
+  LGHeaders::LGHeaders(): known(), resource(nullptr) {};
+  LGHeaders::LGHeaders(std::pmr::memory_resource* resource)
+    : fields(resource),
+      known(),
+      resource(resource),
+      method(resource),
+      path(resource),
+      protocol(resource) {};
+  LGHeaders::LGHeaders(std::string dataStr): dataStr(dataStr), known(), resource(nullptr) {};
+  LGHeaders::LGHeaders(std::unordered_map<std::string, std::string> headers): known(), resource(nullptr) {
+    for (const auto& header : headers) {
+      setHeader(header.first, header.second);
+    }
+  };
+  LGHeaders::LGHeaders(const LGHeaders& oHeaders): known(), resource(nullptr) {
+    copyFrom(oHeaders);
+  }
+  LGHeaders::LGHeaders(LGHeaders&& oHeaders)
+    : dataStr(std::move(oHeaders.dataStr)),
+      fields(std::move(oHeaders.fields)),
+      resource(oHeaders.resource),
+      ownedText(std::move(oHeaders.ownedText)),
+      method(std::move(oHeaders.method)),
+      path(std::move(oHeaders.path)),
+      protocol(std::move(oHeaders.protocol)) {
+    std::copy(std::begin(oHeaders.known), std::end(oHeaders.known), known);
+
+    oHeaders.fields.clear();
+    std::fill(std::begin(oHeaders.known), std::end(oHeaders.known), 0);
+    if (oHeaders.resource == ownedText.get()) oHeaders.resource = nullptr;
+  }
+
+  LGHeaders& LGHeaders::operator=(const LGHeaders& oHeaders) {
+    if (this != &oHeaders) {
+      fields.clear();
+      copyFrom(oHeaders);
+    }
+
+    return *this;
+  }
+
+  LGHeaders& LGHeaders::operator=(LGHeaders&& oHeaders) {
+    if (this == &oHeaders) return *this;
+
+    // The fields stay views into the other headers' text, so its storage comes along
+    if (resource == ownedText.get()) resource = nullptr;
+    ownedText = std::move(oHeaders.ownedText);
+    if (!resource) resource = ownedText.get();
+    if (oHeaders.resource == ownedText.get()) oHeaders.resource = nullptr;
+
+    dataStr = std::move(oHeaders.dataStr);
+    fields = std::move(oHeaders.fields);
+    std::copy(std::begin(oHeaders.known), std::end(oHeaders.known), known);
+    method = std::move(oHeaders.method);
+    path = std::move(oHeaders.path);
+    protocol = std::move(oHeaders.protocol);
+
+    oHeaders.fields.clear();
+    std::fill(std::begin(oHeaders.known), std::end(oHeaders.known), 0);
+
+    return *this;
+  }
+
+  /**
+   * @brief Copies text into the headers' storage. Without a resource the headers get one of their own,
+   * which only grows until the headers are destroyed.
+   * 
+   * @param text The text to keep
+   * @return std::string_view The copy
+   */
+  std::string_view LGHeaders::store(std::string_view text) {
+    if (text.empty()) return std::string_view();
+
+    if (!resource) {
+      ownedText = std::make_unique<std::pmr::monotonic_buffer_resource>();
+      resource = ownedText.get();
+    }
+
+    char* copy = (char*)resource->allocate(text.size(), 1);
+    std::copy(text.begin(), text.end(), copy);
+
+    return std::string_view(copy, text.size());
+  }
+
+  /**
+   * @brief Finds the first field with a name. Well-known names are looked up by index, others by comparing.
+   * 
+   * @param id The id of `name`
+   * @param name The header name
+   * @return size_t The position of the field, npos if there is none
+   */
+  size_t LGHeaders::find(LGHeaderId id, std::string_view name) const {
+    if (id != LGHeaderId::UNKNOWN) {
+      return known[(size_t)id] != 0 ? known[(size_t)id] - 1 : std::string_view::npos;
+    }
+
+    for (size_t i = 0; i < fields.size(); i++) {
+      if (fields[i].id == LGHeaderId::UNKNOWN && equalsIgnoreCase(fields[i].name, name)) return i;
+    }
+
+    return std::string_view::npos;
+  }
+
+  void LGHeaders::copyFrom(const LGHeaders& oHeaders) {
+    dataStr = oHeaders.dataStr;
+    method = oHeaders.method;
+    path = oHeaders.path;
+    protocol = oHeaders.protocol;
+
+    fields.reserve(oHeaders.fields.size());
+
+    for (const LGHeaderField& field : oHeaders.fields) {
+      fields.push_back(LGHeaderField{store(field.name), store(field.value), field.id});
+    }
+
+    std::copy(std::begin(oHeaders.known), std::end(oHeaders.known), known);
   }
 
-  LGHeaders::LGHeaders() {};
-  LGHeaders::LGHeaders(std::string dataStr): dataStr(dataStr) {};
-  LGHeaders::LGHeaders(std::unordered_map<std::string, std::string> headers): headers(headers) {};
-  LGHeaders::LGHeaders(const LGHeaders& oHeaders) {
-    headers = oHeaders.headers;
-    dataStr = oHeaders.getDataStr();
+  void LGHeaders::reindex() {
+    std::fill(std::begin(known), std::end(known), 0);
+
+    for (size_t i = 0; i < fields.size(); i++) {
+      if (fields[i].id != LGHeaderId::UNKNOWN && known[(size_t)fields[i].id] == 0) {
+        known[(size_t)fields[i].id] = (uint32_t)(i + 1);
+      }
+    }
   }
 
   std::string LGHeaders::getDataStr() const {
@@ -170,43 +376,138 @@ namespace LandingGear {
   /**
    * @brief Checks to see if header exists in the list of known headers.
    * 
-   * @param key The header to find
+   * @param key The header to find, in any casing
    * @return true - The header exists
    * @return false - The header does not exist
    */
-  bool LGHeaders::hasHeader(std::string key) {
-    return headers.find(key) != headers.end();
+  bool LGHeaders::hasHeader(std::string_view key) const {
+    return find(headerId(key), key) != std::string_view::npos;
+  }
+
+  bool LGHeaders::hasHeader(LGHeaderId id) const {
+    return id != LGHeaderId::UNKNOWN && known[(size_t)id] != 0;
   }
 
   /**
-   * @brief Gets a header from a string.
+   * @brief Gets a header from a string. Repeated headers give the first value.
    * 
-   * @param key The header name
-   * @return std::string The header data
+   * @param key The header name, in any casing
+   * @return std::string_view The header data, empty if it isn't set. Valid until the header changes
    */
-  std::string LGHeaders::getHeader(std::string key) {
-    return headers[key];
+  std::string_view LGHeaders::getHeader(std::string_view key) const {
+    size_t position = find(headerId(key), key);
+
+    return position != std::string_view::npos ? fields[position].value : std::string_view();
+  }
+
+  std::string_view LGHeaders::getHeader(LGHeaderId id) const {
+    return hasHeader(id) ? fields[known[(size_t)id] - 1].value : std::string_view();
   }
 
   /**
-   * @brief Sets a header from a key, value pair.
+   * @brief Sets a header from a key, value pair. Replaces every header with the same name.
    * 
-   * @param key The header name
+   * @param key The header name, written out as given
    * @param value The value to set the header with
-   * @return std::string 
+   * @return std::string_view The stored value
    */
-  std::string LGHeaders::setHeader(std::string key, std::string value) {
-    return (headers[key] = value);
+  std::string_view LGHeaders::setHeader(std::string_view key, std::string_view value) {
+    LGHeaderId id = headerId(key);
+    size_t position = find(id, key);
+
+    if (position == std::string_view::npos) {
+      return addHeader(key, value);
+    }
+
+    fields[position].value = store(value);
+
+    auto repeated = std::remove_if(fields.begin() + position + 1, fields.end(), [&](const LGHeaderField& field) {
+      return field.id == id && (id != LGHeaderId::UNKNOWN || equalsIgnoreCase(field.name, key));
+    });
+
+    if (repeated != fields.end()) {
+      fields.erase(repeated, fields.end());
+      reindex();
+    }
+
+    return fields[position].value;
   }
 
   /**
-   * @brief Gets a header from a string.
+   * @brief Adds a header, keeping any with the same name (eg. Set-Cookie).
+   * 
+   * @param key The header name, written out as given
+   * @param value The value of the header
+   * @return std::string_view The stored value
+   */
+  std::string_view LGHeaders::addHeader(std::string_view key, std::string_view value) {
+    addHeaderView(store(key), store(value));
+
+    return fields.back().value;
+  }
+
+  /**
+   * @brief Adds a header without copying it, eg. one parsed out of a request kept in the connection's arena.
    * 
    * @param key The header name
-   * @return std::string The header data
+   * @param value The value of the header
+   */
+  void LGHeaders::addHeaderView(std::string_view key, std::string_view value) {
+    if (fields.capacity() == 0) fields.reserve(HEADER_RESERVE);
+
+    LGHeaderId id = headerId(key);
+    fields.push_back(LGHeaderField{key, value, id});
+
+    if (id != LGHeaderId::UNKNOWN && known[(size_t)id] == 0) {
+      known[(size_t)id] = (uint32_t)fields.size();
+    }
+  }
+
+  /**
+   * @brief Removes every header with a name.
+   * 
+   * @param key The header name, in any casing
+   */
+  void LGHeaders::removeHeader(std::string_view key) {
+    LGHeaderId id = headerId(key);
+
+    if (find(id, key) == std::string_view::npos) return;
+
+    fields.erase(std::remove_if(fields.begin(), fields.end(), [&](const LGHeaderField& field) {
+      return field.id == id && (id != LGHeaderId::UNKNOWN || equalsIgnoreCase(field.name, key));
+    }), fields.end());
+
+    reindex();
+  }
+
+  /**
+   * @brief Gets a header from a string.
+   * 
+   * @param key The header name, in any casing
+   * @return std::string_view The header data, empty if it isn't set
    */
-  std::string LGHeaders::operator[](std::string key) {
-    return headers[key];
+  std::string_view LGHeaders::operator[](std::string_view key) const {
+    return getHeader(key);
+  }
+
+  std::string_view LGHeaders::operator[](LGHeaderId id) const {
+    return getHeader(id);
+  }
+
+  size_t LGHeaders::size() const {
+    return fields.size();
+  }
+
+  bool LGHeaders::empty() const {
+    return fields.empty();
+  }
+
+  std::pmr::vector<LGHeaderField>::const_iterator LGHeaders::begin() const {
+    return fields.begin();
+  }
+
+  std::pmr::vector<LGHeaderField>::const_iterator LGHeaders::end() const {
+    return fields.end();
   }
 
   /**
@@ -304,13 +605,52 @@ namespace LandingGear {
     return headers;
   }
 
-  LGResponse::LGResponse() {
+  // Appends a number in decimal without going through a stream or a temporary string
+  static void appendNumber(std::string& out, uint64_t value) {
+    char digits[20];
+    char* end = std::to_chars(digits, digits + sizeof(digits), value).ptr;
+
+    out.append(digits, end - digits);
+  }
+
+  /**
+   * @brief The Date header line for the current second. Each thread formats it at most once a second,
+   * every other response in that second reuses it.
+   * 
+   * @return const std::string& The line (eg. "Date: Sun, 06 Nov 1994 08:49:37 GMT\r\n")
+   */
+  static const std::string& currentDateLine() {
+    thread_local int64_t second = -1;
+    thread_local std::string line;
+
+    int64_t now = (int64_t)std::time(nullptr);
+
+    if (now != second) {
+      second = now;
+      line = "Date: " + formatHttpDate(now) + "\r\n";
+    }
+
+    return line;
+  }
+
+  // Statuses that never have a body, nor Content-Type and Content-Length headers describing one
+  static bool isBodyless(int code) {
+    return code == 204 || code == 304 || (code >= 100 && code < 200);
+  }
+
+  LGResponse::LGResponse(): connection(nullptr), chunked(false), statusSet(false) {
     statusCode = 404;
-    headers = LGHeaders();
+    headersSent = false;
+    skipBody = false;
+    streaming = false;
+    waitingForDrain = false;
   };
-  LGResponse::LGResponse(LGClientSocket socket): socket(socket) {
+  LGResponse::LGResponse(LGConnection* connection): connection(connection), chunked(false), statusSet(false), headers(&connection->arena) {
     statusCode = 404;
-    headers = LGHeaders();
+    headersSent = false;
+    skipBody = false;
+    streaming = false;
+    waitingForDrain = false;
   };
 
   /**
@@ -320,7 +660,6 @@ namespace LandingGear {
    * @param value The value or data of the header
    */
   void LGResponse::header(std::string header, std::string value) {
-    toLowerCase(header);
     headers.setHeader(header, value);
   };
 
@@ -331,9 +670,10 @@ namespace LandingGear {
    * @param value The value of the header
    */
   void LGResponse::header(std::string header, int value) {
-    std::ostringstream o;
-    o << value;
-    this->header(header, o.str());
+    char digits[12];
+    char* end = std::to_chars(digits, digits + sizeof(digits), value).ptr;
+
+    headers.setHeader(header, std::string_view(digits, end - digits));
   };
 
   /**
@@ -357,332 +697,2178 @@ namespace LandingGear {
    */
   LGResponse& LGResponse::status(int code) {
     statusCode = code;
+    statusSet = true;
 
     return *this;
   };
 
   /**
-   * @brief Sends data with a specified status code.
+   * @brief Sends data with a specified status code. The data goes through `bodyFilter` first, if one is set.
    * 
    * @param code The status code to be sent (eg. 200)
    * @param data The data to be sent
    */
   LGResponse& LGResponse::send(int code, std::string data) {
+    if (streaming) {
+      write(std::move(data));
+      return end();
+    }
+
     status(code);
 
-    if (!headers.hasHeader("content-type")) {
-      header("Content-Type", "text/plain");
-    }
+    if (bodyFilter && !skipBody && !isBodyless(statusCode)) {
+      LGBodyFilter filter = std::move(bodyFilter);
+      bodyFilter = nullptr;
 
-    if (!headers.hasHeader("content-length")) {
-      header("Content-Length", data.size());
+      if (filter(*this, data)) {
+        return *this; // the filter sent the response itself
+      }
     }
 
-    std::ostringstream resString;
-    resString << "HTTP/1.1 " << statusCode << " " << statusCodes[statusCode] << "\r\n"
-      << "Connection: keep-alive\r\n"
-      << "Content-Type: " << headers["content-type"] << "\r\n"
-      << "Content-Length: " << headers["content-length"] << "\r\n"
-      << "\r\n";
+    // The head and the body go out with one gathered send, the body is moved along and never copied
+    std::string buffers[2] = {buildHead(data.size()), std::move(data)};
+    connection->writeBuffers(buffers, skipBody || isBodyless(statusCode) ? 1 : 2);
 
-    sendString(resString.str());
-    int bytes = sendString(data);
-
-    if (bytes >= std::stoi(headers["content-length"])) {
-      headersSent = true;
-    }
+    complete(); // even if the write failed, the connection is closed and nothing else can be sent
 
     return *this;
   };
 
   /**
-   * @brief Send a string to the client. Abstracts away socket functions.
-   * Automatically sends status code 200.
+   * @brief Sends a whole file with status code 200.
    * 
-   * @param data The data to be sent.
+   * @param file The file, usually from an `LGFileCache`
    */
-  LGResponse& LGResponse::send(std::string data) {
-    send(200, data);
+  LGResponse& LGResponse::sendFile(std::shared_ptr<LGFile> file) {
+    uint64_t size = file->info.size;
 
-    return *this;
+    return sendFile(200, std::move(file), 0, size);
   };
 
   /**
-   * @brief Send a string to the client. Abstracts away socket functions.
-   * Sends the set status code.
+   * @brief Sends part of a file with a specified status code. The file is written to the socket
+   * straight from the file system and is kept open until it has been sent.
    * 
-   * @param data The data to be sent.
+   * @param code The status code to be sent (eg. 200)
+   * @param file The file
+   * @param offset The first byte to send
+   * @param length The amount of bytes to send
    */
-  LGResponse& LGResponse::end(std::string data) {
-    send(statusCode, data);
+  LGResponse& LGResponse::sendFile(int code, std::shared_ptr<LGFile> file, uint64_t offset, uint64_t length) {
+    status(code);
+
+    std::string head = buildHead(length);
+
+    if (skipBody || length == 0) {
+      connection->writeBuffers(&head, 1);
+    } else {
+      connection->writeFile(std::move(head), std::move(file), offset, length);
+    }
+
+    complete();
 
     return *this;
   };
 
   /**
-   * @brief Sends a string to the client. A wrapper for 'send' syscall/function call.
+   * @brief Sends ranges of a file as a 206 response. A single range is sent as is with a Content-Range header,
+   * several are sent as multipart/byteranges with each part written straight from the file system.
+   * The Content-Type header, if set, is the type of every part.
    * 
-   * @param data The data to be sent
-   * @return int The amount of bytes sent
+   * @param file The file
+   * @param ranges The ranges to send, in order. Every range must be within the file
    */
-  int LGResponse::sendString(std::string data) {
-    return socket.send((char*)data.c_str(), data.size());
-  };
+  LGResponse& LGResponse::sendFileRanges(std::shared_ptr<LGFile> file, const std::vector<LGByteRange>& ranges) {
+    std::string total = "/" + std::to_string(file->info.size);
 
-  LGRequest::LGRequest() {};
-  LGRequest::LGRequest(LGClientSocket socket): socket(socket) {};
+    if (ranges.size() == 1) {
+      const LGByteRange& range = ranges[0];
 
-  /**
-   * @brief Process current request. Constructs response object and fills information of the request into the Request object.
-   * 
-   * @return std::string The full body of the request
-   */
-  std::string LGRequest::getRequest() {    
-    int bytes = 0;
+      header("Content-Range", "bytes " + std::to_string(range.offset) + "-"
+        + std::to_string(range.offset + range.length - 1) + total);
 
-    std::string fullData = "";
+      return sendFile(206, std::move(file), range.offset, range.length);
+    }
 
-    bool gotRequest = false;
-    bool recievedHeaders = false;
+    static std::atomic<uint64_t> boundaries(0);
 
-    std::string headersString = "";
-    int headerStartIndex = 0;
+    char boundary[40];
+    snprintf(boundary, sizeof(boundary), "LGByteRanges%016llx%08llx",
+      (unsigned long long)std::chrono::steady_clock::now().time_since_epoch().count(), (unsigned long long)boundaries++);
 
-    bool nextCalled = true;
-    int index = 0;
+    std::string partType;
 
-    LGResponse res = LGResponse(socket);
-    res.app = app;
-    std::vector<LGMiddleware> middleware = app->middleware;
+    if (headers.hasHeader(LGHeaderId::CONTENT_TYPE)) {
+      partType = "\r\nContent-Type: ";
+      partType += headers[LGHeaderId::CONTENT_TYPE];
+    }
 
-    NextFunction next = [&]() {
-      nextCalled = true;
-      index++;
-    };
+    std::vector<std::string> partHeads;
+    uint64_t length = 0;
 
-    std::function<void(LGMiddleware, LGRequest*)> checkMiddle = [&res, &next](LGMiddleware middle, LGRequest* req) {
-      std::string path = req->path;
-      std::string mpath = middle.path;
-      trim(path);
-      trim(mpath);
+    partHeads.reserve(ranges.size());
 
-      if (startsWith(path, "/")) {
-        path = path.substr(1); // /home/nice
-      }
-      if (startsWith(mpath, "/")) {
-        mpath = mpath.substr(1); // /home/:monkey
-      }
-      
-      if (middle.method == "USE") {
-        if (mpath.size() > 0) {
-          if (startsWith(path, mpath)) {
-            middle.call(*req, res, next);
-          } else {
-            next();
-          }
-        } else {
-          middle.call(*req, res, next);
-        }
-      } else {
-        std::vector<std::string> reqPaths = split(path, "/"); // [home, nice]
-        std::vector<std::string> methodPaths = split(mpath, "/"); // [home, :monkey]
-
-        bool isCorrectPath = path == middle.path || (reqPaths.size() == 0 && methodPaths.size() == 0);
-
-        if (middle.method == req->method) {
-          if (!isCorrectPath && reqPaths.size() == methodPaths.size()) {
-            for (int i = 0; i < reqPaths.size(); i++) {
-              std::string currentPath = reqPaths[i];
-              std::string currentMPath = methodPaths[i];
-
-              if (currentPath == currentMPath) {
-                isCorrectPath = true;
-                continue;
-              } else if (!startsWith(currentMPath, ":") && !startsWith(currentMPath, "*")) {
-                isCorrectPath = false;
-                break;
-              }
-
-              if (startsWith(currentMPath, ":")) {
-                req->params[currentMPath.substr(1)] = currentPath;
-              }
-            }
-          }
+    for (const LGByteRange& range : ranges) {
+      std::string partHead = "\r\n--";
+      partHead += boundary;
+      partHead += partType;
+      partHead += "\r\nContent-Range: bytes ";
+      partHead += std::to_string(range.offset);
+      partHead += "-";
+      partHead += std::to_string(range.offset + range.length - 1);
+      partHead += total;
+      partHead += "\r\n\r\n";
 
-          if (isCorrectPath) {
-            middle.call(*req, res, next);
-          } else {
-            next();
-          }
-        }
-      }
-    };
+      length += partHead.size() + range.length;
+      partHeads.push_back(std::move(partHead));
+    }
 
-    do {
-      char buffer[512] = {'\0'};
+    std::string closing = "\r\n--";
+    closing += boundary;
+    closing += "--\r\n";
+    length += closing.size();
 
-      std::string currentData = "";
-      bytes = socket.receive(buffer, 511);
+    status(206);
+    header("Content-Type", std::string("multipart/byteranges; boundary=") + boundary);
 
-      if (bytes <= 0) {
-        break;
+    std::string head = buildHead(length);
+
+    if (skipBody) {
+      connection->writeBuffers(&head, 1);
+    } else {
+      // Every part is queued behind the previous one, so memory stays flat however large the file is
+      for (size_t i = 0; i < ranges.size(); i++) {
+        std::string partHead = i == 0 ? head + partHeads[i] : std::move(partHeads[i]);
+        connection->writeFile(std::move(partHead), file, ranges[i].offset, ranges[i].length);
       }
 
-      buffer[bytes] = '\0';
-      currentData = buffer;
-      ltrim(currentData);
+      connection->writeBuffers(&closing, 1);
+    }
 
-      if (!gotRequest && (includes(currentData, "\r\n") || includes(currentData, "\n"))) {
-        gotRequest = true;
+    complete();
 
-        headerStartIndex = currentData.find("\r\n");
-        if (headerStartIndex == std::string::npos) {
-          headerStartIndex = currentData.find("\n");
-        }
+    return *this;
+  };
 
-        std::string reqInfoStr = currentData.substr(0, headerStartIndex);
+  /**
+   * @brief Sends a 200 response whose headers and body were serialized ahead of time, eg. by an `LGAssetCache`.
+   * Only the status line and Connection header are added, the rest is shared with the cache, never copied.
+   * 
+   * @param prepared The headers after the Connection and Date headers, the blank line and the body
+   */
+  LGResponse& LGResponse::sendPrepared(std::shared_ptr<const std::string> prepared) {
+    status(200);
 
-        LGHeaders reqInfo = LGHeaders::constructRequestInfo(reqInfoStr);
-        method = reqInfo.method;
-        path = reqInfo.path;
-        protocol = reqInfo.protocol;
-      }
+    std::string head = "HTTP/1.1 200 OK\r\n";
+    head += connection->keepAlive ? "Connection: keep-alive\r\n" : "Connection: close\r\n";
+    head += currentDateLine();
 
-      if (!recievedHeaders && (includes(currentData, "\r\n\r\n") || includes(currentData, "\n\n"))) {
-        recievedHeaders = true;
+    connection->writeShared(std::move(head), std::move(prepared));
 
-        int endingIndex = currentData.find("\r\n\r\n");
-        if (endingIndex == std::string::npos) {
-          endingIndex = currentData.find("\n\n");
-        }
+    complete();
 
-        headersString = fullData.substr(headerStartIndex, endingIndex - headerStartIndex);
-        trim(headersString);
-        headers = LGHeaders::constructHeaders(headersString);
-        headers.method = method;
-        headers.path = path;
-        headers.protocol = protocol;
+    return *this;
+  };
 
-        url = startsWith(protocol, "HTTPS") ? "https" : "http://";
-        url += headers["host"];
-        url += path;
-      }
+  /**
+   * @brief Builds the status line and headers. Fills in Content-Type and Content-Length if they aren't set,
+   * both are left out for statuses without a body (eg. 304).
+   * 
+   * @param contentLength The size of the body
+   * @return std::string The head, ending with the blank line
+   */
+  std::string LGResponse::buildHead(uint64_t contentLength) {
+    std::string head = buildFields();
 
-      if (recievedHeaders && nextCalled) {
-        nextCalled = false;
+    if (!isBodyless(statusCode)) {
+      head += "Content-Length: ";
 
-        LGMiddleware middle = middleware[index];
-        checkMiddle(middle, this);
+      if (headers.hasHeader(LGHeaderId::CONTENT_LENGTH)) {
+        head += headers[LGHeaderId::CONTENT_LENGTH];
+      } else {
+        appendNumber(head, contentLength);
       }
 
-      fullData += currentData;
+      head += "\r\n";
+    }
 
-      this->emit("data", EventData(EventType::CHUNK, currentData));
+    head += "\r\n";
 
-      if (bytes != 511 || res.headersSent) {
-        break;
-      }
-    } while (bytes > 0);
+    return head;
+  };
 
-    while (index < middleware.size() && !res.headersSent) {
-      if (!nextCalled) {
-        break;
-      }
+  /**
+   * @brief Builds the status line and every header but Content-Length, for heads whose body size
+   * isn't known yet. Fills in Content-Type if it isn't set.
+   * 
+   * @return std::string The head without the Content-Length header and the blank line
+   */
+  std::string LGResponse::buildFields() {
+    if (includesIgnoreCase(headers[LGHeaderId::CONNECTION], "close")) {
+      connection->keepAlive = false;
+    }
 
-      nextCalled = false;
-      
-      LGMiddleware middle = middleware[index];
-      checkMiddle(middle, this);
+    std::string head;
+    head.reserve(256);
+
+    std::string_view line = statusLine(statusCode);
+
+    if (!line.empty()) {
+      head += line;
+    } else {
+      head += "HTTP/1.1 ";
+      appendNumber(head, (uint64_t)statusCode);
+      head += " \r\n";
     }
 
-    if (!res.headersSent) {
-      res.status(404).end("Page Not Found!");
+    head += connection->keepAlive ? "Connection: keep-alive\r\n" : "Connection: close\r\n";
+
+    if (!headers.hasHeader(LGHeaderId::DATE)) {
+      head += currentDateLine();
     }
 
-    this->emit("end", EventData(EventType::CHUNK, fullData));
-    socket.close();
+    if (!isBodyless(statusCode)) {
+      head += "Content-Type: ";
+      head += headers.hasHeader(LGHeaderId::CONTENT_TYPE) ? headers[LGHeaderId::CONTENT_TYPE] : "text/plain";
+      head += "\r\n";
+    }
 
-    return fullData;
-  }
+    for (const LGHeaderField& field : headers) {
+      if (field.id == LGHeaderId::CONNECTION || field.id == LGHeaderId::CONTENT_TYPE || field.id == LGHeaderId::CONTENT_LENGTH) continue;
 
-  LGMiddleware::LGMiddleware() {};
-  LGMiddleware::LGMiddleware(std::string path): path(path) {};
-  LGMiddleware::LGMiddleware(std::string path, const char* method): path(path), method(method) {};
-  LGMiddleware::LGMiddleware(std::string path, bool isWildcard): path(path), isWildcard(isWildcard) {};
-  LGMiddleware::LGMiddleware(LGMiddlewareCB cb): cb(cb) {};
-  LGMiddleware::LGMiddleware(LGMiddlewareCB cb, std::string method): cb(cb), method(method) {};
+      head += field.name;
+      head += ": ";
+      head += field.value;
+      head += "\r\n";
+    }
 
-  LGMiddleware::LGMiddleware(std::string path, const char* method, LGMiddlewareCB cb)
-    : path(path),
-      method(method),
-      cb(cb) {};
-  LGMiddleware::LGMiddleware(std::string path, const char* method, ReqCallback cb)
-    : path(path),
-      method(method) {
-    this->cb = [&](LGRequest& req, LGResponse& res, NextFunction next) {
-      cb(req, res);
-      if (!res.headersSent) {
-        next();
+    return head;
+  };
+
+  /**
+   * @brief Sends the head right away and a body produced on a pool, so a slow body (eg. a large one
+   * being compressed) doesn't hold up the connection's thread. Responses after it are written once
+   * it is done. Without an event loop the body is produced on the calling thread.
+   * 
+   * @param pool The pool to produce the body on
+   * @param produce Returns the body, runs on a pool thread
+   */
+  LGResponse& LGResponse::sendDeferred(LGWorkerPool& pool, std::function<std::string(void)> produce) {
+    bool bodyless = isBodyless(statusCode);
+    bool skip = skipBody || bodyless;
+
+    connection->writeDeferred(buildFields(), pool, [produce = std::move(produce), bodyless, skip]() {
+      std::string body = produce();
+      std::string rest;
+
+      if (!bodyless) {
+        rest.reserve(32 + (skip ? 0 : body.size()));
+        rest += "Content-Length: ";
+        appendNumber(rest, body.size());
+        rest += "\r\n";
       }
-    };
-  }
 
-  // Calls the callback (cb)
-  void LGMiddleware::call(LGRequest& req, LGResponse& res, std::function<void(void)> next) {
-    cb(req, res, next);
-  }
+      rest += "\r\n";
 
-  LandingGear::LandingGear() {
-    socket = LGServerSocket();
-  }
+      if (!skip) rest += body;
 
-  void LandingGear::get(std::string path, ReqCallback cb) {
-    LGMiddleware middlew = LGMiddleware(path, "GET");
-    middlew.cb = [&](LGRequest& req, LGResponse& res, NextFunction next) {
+      return rest;
+    });
+
+    complete();
+
+    return *this;
+  };
+
+  /**
+   * @brief Marks the response as handed to the connection and emits "finish".
+   * 
+   */
+  void LGResponse::complete() {
+    headersSent = true;
+    this->emit("finish", EventData(EventType::CHUNK));
+  }
+
+  /**
+   * @brief Sends the head of a streamed response, with status 200 unless `status` was called.
+   * The body is chunked unless a Content-Length was set,
+   * HTTP/1.0 clients, which don't know chunked encoding, get a body that ends with the connection.
+   * 
+   */
+  void LGResponse::startStream() {
+    if (!statusSet) {
+      statusCode = 200;
+    }
+
+    bool bodyless = isBodyless(statusCode);
+
+    if (streamFilter && !skipBody && !bodyless) {
+      LGStreamFilter filter = std::move(streamFilter);
+      streamFilter = nullptr;
+
+      encoder = filter(*this);
+    }
+
+    chunked = !bodyless && !headers.hasHeader(LGHeaderId::CONTENT_LENGTH) && connection->request.protocol != "HTTP/1.0";
+
+    if (!bodyless && !chunked && !headers.hasHeader(LGHeaderId::CONTENT_LENGTH)) {
+      connection->keepAlive = false;
+    }
+
+    headers.removeHeader("Transfer-Encoding"); // the framing is ours to pick
+
+    std::string head = buildFields();
+
+    if (chunked) {
+      head += "Transfer-Encoding: chunked\r\n";
+    } else if (!bodyless && headers.hasHeader(LGHeaderId::CONTENT_LENGTH)) {
+      head += "Content-Length: ";
+      head += headers[LGHeaderId::CONTENT_LENGTH];
+      head += "\r\n";
+    }
+
+    head += "\r\n";
+
+    connection->writeBuffers(&head, 1);
+
+    headersSent = true;
+    streaming = true;
+  }
+
+  /**
+   * @brief Writes part of the body, sending the head first if it hasn't been. The response stays open
+   * until `end` is called. Returns false once more than the app's `highWaterMark` is waiting to be written,
+   * stop writing until "drain" is emitted to keep the memory of the response bounded. Blocking
+   * connections wait for the socket instead and only return false when the connection is broken.
+   * 
+   * A streamed response that is still open when the middleware returns, or when a "drain" listener
+   * returns, is ended right away unless a write is waiting for "drain".
+   * 
+   * @param chunk The data
+   * @return LGWriteResult True when more can be written, false to wait for "drain" or when the connection is broken
+   */
+  LGWriteResult LGResponse::write(std::string chunk) {
+    if (!headersSent) {
+      startStream();
+    }
+
+    if (!streaming) {
+      return LGWriteResult{this, false, false}; // the response was sent or ended already
+    }
+
+    if (!chunk.empty() && !skipBody && !isBodyless(statusCode)) {
+      if (encoder) {
+        chunk = encoder->encode(chunk, false);
+      }
+
+      if (!chunk.empty() && writeChunk(std::move(chunk)) < 0) {
+        return LGWriteResult{this, false, false};
+      }
+    }
+
+    if (connection->outputSize >= app->highWaterMark) {
+      connection->flush(); // even while corked, a stream must not pile up behind the batch
+    }
+
+    waitingForDrain = connection->outputSize >= app->highWaterMark;
+
+    return LGWriteResult{this, !waitingForDrain, waitingForDrain};
+  }
+
+  /**
+   * @brief Writes encoded body data to the connection, framed as a chunk when the body is chunked.
+   * 
+   * @param chunk The data, not empty
+   * @return int The result of the write, negative when the connection is broken
+   */
+  int LGResponse::writeChunk(std::string chunk) {
+    if (!chunked) {
+      return connection->writeBuffers(&chunk, 1);
+    }
+
+    char size[16];
+    char* end = std::to_chars(size, size + sizeof(size) - 2, (uint64_t)chunk.size(), 16).ptr;
+    *end++ = '\r';
+    *end++ = '\n';
+
+    std::string buffers[3] = {std::string(size, end - size), std::move(chunk), std::string("\r\n")};
+    return connection->writeBuffers(buffers, 3);
+  }
+
+  /**
+   * @brief Sends the head if it hasn't been sent and writes out everything written so far,
+   * even while responses of pipelined requests are being collected. An encoder (eg. from `compress`)
+   * gives up the data it held back, at the cost of some compression.
+   * 
+   */
+  LGResponse& LGResponse::flush() {
+    if (!headersSent) {
+      startStream();
+    }
+
+    if (encoder && streaming) {
+      std::string pending = encoder->encode(std::string_view(), true);
+
+      if (!pending.empty()) {
+        writeChunk(std::move(pending));
+      }
+    }
+
+    connection->flush();
+
+    return *this;
+  }
+
+  /**
+   * @brief Ends the response. Finishes a streamed response, or sends an empty body if nothing was sent yet.
+   * 
+   */
+  LGResponse& LGResponse::end() {
+    if (!headersSent) {
+      return send(statusCode, std::string());
+    }
+
+    if (!streaming) {
+      return *this;
+    }
+
+    streaming = false;
+    waitingForDrain = false;
+
+    if (encoder) {
+      std::string rest = encoder->finish();
+      encoder.reset();
+
+      if (!rest.empty()) {
+        writeChunk(std::move(rest));
+      }
+    }
+
+    if (chunked && !skipBody) {
+      static const char lastChunk[] = "0\r\n\r\n";
+      connection->write(lastChunk, sizeof(lastChunk) - 1);
+    }
+
+    complete();
+
+    return *this;
+  }
+
+  /**
+   * @brief Send a string to the client. Abstracts away socket functions.
+   * Automatically sends status code 200.
+   * 
+   * @param data The data to be sent.
+   */
+  LGResponse& LGResponse::send(std::string data) {
+    send(200, std::move(data));
+
+    return *this;
+  };
+
+  /**
+   * @brief Send a string to the client. Abstracts away socket functions.
+   * Sends the set status code.
+   * 
+   * @param data The data to be sent.
+   */
+  LGResponse& LGResponse::end(std::string data) {
+    send(statusCode, std::move(data));
+
+    return *this;
+  };
+
+  /**
+   * @brief Sends a string to the client. A wrapper for 'send' syscall/function call.
+   * 
+   * @param data The data to be sent
+   * @return int The amount of bytes sent
+   */
+  int LGResponse::sendString(std::string data) {
+    return connection->writeBuffers(&data, 1);
+  };
+
+  LGRequest::LGRequest()
+    : connection(nullptr),
+      bodyRead(false),
+      collectBody(false),
+      chainPosition(0),
+      heldBy(NO_HOLDER),
+      nextCalled(false),
+      chainRunning(false),
+      methodId(LGMethod::HTTP_UNKNOWN),
+      app(nullptr),
+      state(LGRequestState::HEADERS) {};
+  LGRequest::LGRequest(LGConnection* connection)
+    : connection(connection),
+      bodyRead(false),
+      collectBody(false),
+      chainPosition(0),
+      heldBy(NO_HOLDER),
+      nextCalled(false),
+      chainRunning(false),
+#ifdef LG_HAS_COROUTINES
+      continuations(&connection->arena),
+      tasks(&connection->arena),
+#endif
+      url(&connection->arena),
+      path(&connection->arena),
+      method(&connection->arena),
+      protocol(&connection->arena),
+      methodId(LGMethod::HTTP_UNKNOWN),
+      headers(&connection->arena),
+      params(&connection->arena),
+      app(connection->app),
+      state(LGRequestState::HEADERS) {};
+
+  /**
+   * @brief Process current request. Consumes what the connection has received so far and
+   * can be called again whenever more data arrives. The middleware stack runs once the body
+   * has been read, or as soon as the headers are complete when bodies are streamed.
+   * 
+   * @return LGRequestState The state the request is in after consuming the available data
+   */
+  LGRequestState LGRequest::getRequest() {
+    if (state == LGRequestState::HEADERS) {
+      readHead();
+    }
+
+    if (state == LGRequestState::BODY) {
+      readBody();
+    }
+
+    return state;
+  }
+
+  /**
+   * @brief The request body. Only filled once the body has been read and when bodies aren't streamed.
+   * 
+   * @return const std::string& The body
+   */
+  const std::string& LGRequest::body() const {
+    return bodyData;
+  }
+
+  /**
+   * @brief Parses the request line and headers, then works out how the body is framed.
+   * 
+   */
+  void LGRequest::readHead() {
+    std::string& input = connection->input;
+    LGRequestParser& parser = connection->parser;
+
+    LGParseResult result = parser.parse(input.data(), input.size());
+
+    if (result == LGParseResult::INCOMPLETE) {
+      return; // wait for the rest of the headers
+    }
+
+    if (result == LGParseResult::ERROR) {
+      fail(parser.errorCode);
+      return;
+    }
+
+    // Everything below is allocated from the connection's arena. The head is copied out of `input` once
+    // and the headers are views into that copy
+    char* head = (char*)connection->arena.allocate(parser.consumed, 1);
+    std::copy(input.data(), input.data() + parser.consumed, head);
+
+    auto rebase = [&](std::string_view view) {
+      return std::string_view(head + (view.data() - input.data()), view.size());
+    };
+
+    method.assign(parser.method);
+    methodId = parser.methodId;
+    path.assign(parser.path);
+    protocol.assign(parser.protocol);
+
+    for (const LGHeaderView& header : parser.headers) {
+      headers.addHeaderView(rebase(header.name), rebase(header.value));
+    }
+
+    headers.method = method;
+    headers.path = path;
+    headers.protocol = protocol;
+
+    url.assign(startsWith(protocol, "HTTPS") ? "https://" : "http://");
+    url += headers[LGHeaderId::HOST];
+    url += path;
+
+    input.erase(0, parser.consumed); // the body and anything after it belongs to the reader
+
+    std::string_view connectionHeader = headers[LGHeaderId::CONNECTION];
+
+    bool keepAlive = protocol == "HTTP/1.0"
+      ? includesIgnoreCase(connectionHeader, "keep-alive")
+      : !includesIgnoreCase(connectionHeader, "close");
+
+    if (app->maxRequestsPerConnection > 0 && connection->requestCount + 1 >= app->maxRequestsPerConnection) {
+      keepAlive = false;
+    }
+
+    connection->keepAlive = keepAlive;
+
+    LGBodyReader& reader = connection->bodyReader;
+    reader.reset();
+
+    if (headers.hasHeader(LGHeaderId::TRANSFER_ENCODING)) {
+      std::string_view codings = headers[LGHeaderId::TRANSFER_ENCODING];
+      std::string_view lastCoding = codings.substr(codings.rfind(',') + 1); // npos + 1 takes the whole string
+
+      while (!lastCoding.empty() && std::isspace((unsigned char)lastCoding.front())) lastCoding.remove_prefix(1);
+      while (!lastCoding.empty() && std::isspace((unsigned char)lastCoding.back())) lastCoding.remove_suffix(1);
+
+      if (!equalsIgnoreCase(lastCoding, "chunked")) {
+        fail(400);
+        return;
+      }
+
+      // A Content-Length next to chunked encoding is ignored, but the connection isn't trusted after it
+      if (headers.hasHeader(LGHeaderId::CONTENT_LENGTH)) {
+        connection->keepAlive = false;
+      }
+
+      reader.expectChunked();
+    } else if (headers.hasHeader(LGHeaderId::CONTENT_LENGTH)) {
+      std::string_view lengthHeader = headers[LGHeaderId::CONTENT_LENGTH];
+      uint64_t length = 0;
+
+      if (lengthHeader.empty() || lengthHeader.size() > 18 || lengthHeader.find_first_not_of("0123456789") != std::string_view::npos) {
+        fail(400);
+        return;
+      }
+
+      for (char c : lengthHeader) {
+        length = length * 10 + (c - '0');
+      }
+
+      if (app->maxBodySize > 0 && length > app->maxBodySize) {
+        fail(413);
+        return;
+      }
+
+      reader.expectLength(length);
+    }
+
+    if (!reader.done() && protocol != "HTTP/1.0") {
+      if (equalsIgnoreCase(headers[LGHeaderId::EXPECT], "100-continue")) {
+        static const char continueLine[] = "HTTP/1.1 100 Continue\r\n\r\n";
+        connection->write(continueLine, sizeof(continueLine) - 1);
+      }
+    }
+
+    state = LGRequestState::BODY;
+
+    if (app->streamBodies) {
+      dispatch();
+    }
+  }
+
+  /**
+   * @brief Decodes the body received so far. Finishes the request once the whole body is in,
+   * or once middleware that continues asynchronously is done after that.
+   * 
+   */
+  void LGRequest::readBody() {
+    std::string& input = connection->input;
+    LGBodyReader& reader = connection->bodyReader;
+
+    LGBodyResult result = reader.decode(input.data(), input.size());
+
+    for (std::string_view chunk : reader.chunks) {
+      if (app->streamBodies && !collectBody) {
+        this->emit("data", EventData(EventType::CHUNK, std::string(chunk)));
+        continue;
+      }
+
+      if (app->maxBodySize > 0 && bodyData.size() + chunk.size() > app->maxBodySize) {
+        fail(413);
+        return;
+      }
+
+      bodyData.append(chunk.data(), chunk.size());
+    }
+
+    input.erase(0, reader.consumed);
+
+    if (result == LGBodyResult::ERROR) {
+      fail(reader.errorCode);
+      return;
+    }
+
+    if (result == LGBodyResult::INCOMPLETE) {
+      return; // wait for the rest of the body
+    }
+
+    bodyRead = true;
+
+    if (!app->streamBodies) {
+      dispatch();
+
+      if (!bodyData.empty() && this->listenerCount("data") > 0) {
+        this->emit("data", EventData(EventType::CHUNK, bodyData));
+      }
+    }
+
+    this->emit("end", EventData(EventType::CHUNK));
+
+#ifdef LG_HAS_COROUTINES
+    if (bodyWaiter) {
+      resume(std::exchange(bodyWaiter, nullptr));
+    }
+#endif
+
+    if (heldBy != NO_HOLDER) {
+      state = LGRequestState::WAITING; // finished by continueChain once the middleware is done
+      return;
+    }
+
+    finish();
+  }
+
+  /**
+   * @brief Answers with an error status, unless a response was already sent, and stops reading
+   * from the connection since the rest of its data can't be trusted.
+   * 
+   * @param code The status code
+   */
+  void LGRequest::fail(int code) {
+    LGResponse& res = connection->response;
+
+    connection->keepAlive = false;
+    connection->input.clear();
+
+    if (!res.headersSent) {
+      res.status(code).end(statusReason(code));
+    }
+
+    state = LGRequestState::FINISHED;
+  }
+
+  /**
+   * @brief Runs the middleware stack against the request.
+   * 
+   */
+  void LGRequest::dispatch() {
+    connection->response.skipBody = methodId == LGMethod::HTTP_HEAD;
+
+    std::string_view routePath = std::string_view(path);
+    routePath = routePath.substr(0, routePath.find('?'));
+
+    app->getRouter().match(routePath, methodId, connection->routeMatches);
+
+    chainPosition = 0;
+    nextCalled = true;
+
+    continueChain();
+  }
+
+  /**
+   * @brief Runs middleware until one doesn't call `next`, the response is sent or the stack ends.
+   * Stops while middleware continues asynchronously and is called again once it let go, either by
+   * calling `next` or by finishing. Coroutines in `co_await next()` are resumed once the stack is done,
+   * then a request whose body is in is finished.
+   * 
+   */
+  void LGRequest::continueChain() {
+    if (chainRunning || state == LGRequestState::FINISHED) {
+      return; // picked up by the loop below, or the request failed meanwhile
+    }
+
+    chainRunning = true;
+
+    LGResponse& res = connection->response;
+    const std::vector<LGMiddleware>& middleware = app->middleware; // frozen by listen, safe to share between workers
+    LGRouteMatches& matches = connection->routeMatches;
+
+    // Only captures `this` so it fits in std::function's inline buffer, building it never allocates.
+    NextFunction next = [this]() {
+      nextCalled = true;
+      chainPosition++;
+    };
+
+    while (heldBy == NO_HOLDER) {
+      if (nextCalled && chainPosition < matches.size() && !res.headersSent) {
+        nextCalled = false;
+
+        const LGRouteMatch& match = matches[chainPosition];
+
+        for (size_t i = 0; i < match.paramNames->size(); i++) {
+          std::string_view value = matches.values[match.paramStart + i];
+          params[std::pmr::string((*match.paramNames)[i], &connection->arena)].assign(value.data(), value.size());
+        }
+
+        middleware[match.index].call(*this, res, next);
+        continue;
+      }
+
+#ifdef LG_HAS_COROUTINES
+      if (!continuations.empty()) {
+        LGContinuation continuation = continuations.back();
+        continuations.pop_back();
+
+        heldBy = continuation.position; // until the coroutine of that entry finishes
+        continuation.handle.resume();
+        continue;
+      }
+#endif
+
+      break;
+    }
+
+    chainRunning = false;
+
+    if (heldBy == NO_HOLDER && state == LGRequestState::WAITING) {
+      finish();
+    }
+  }
+
+  // `next` of the middleware at `position`. Later calls, and calls after the stack moved on, are ignored
+  void LGRequest::advanceFrom(size_t position) {
+    if (chainPosition != position || nextCalled) {
+      return;
+    }
+
+    nextCalled = true;
+    chainPosition++;
+
+    if (heldBy == position) {
+      heldBy = NO_HOLDER; // picked up by continueChain once the middleware returns
+    }
+  }
+
+  /**
+   * @brief Lets the calling middleware finish later, in place of calling `next`. The middleware stack waits,
+   * without blocking the connection's thread, until the returned continuation is called from any thread.
+   * Call it to move on to the next middleware, or pass it a callback, which runs on the connection's thread
+   * in place of the middleware, eg. to respond with what was looked up.
+   * 
+   * @return LGDeferredNext The continuation
+   */
+  LGDeferredNext LGRequest::defer() {
+    heldBy = chainPosition;
+
+    return LGDeferredNext(connection->getParking(), connection->requestCount, chainPosition);
+  }
+
+  /**
+   * @brief Runs the continuation of a deferred middleware, then moves the stack on.
+   * 
+   * @param position The entry of the route matches that deferred
+   * @param then Called like the middleware, with a `next` of its own
+   */
+  void LGRequest::continueDeferred(size_t position, const LGMiddlewareCB& then) {
+    if (heldBy != position || state == LGRequestState::FINISHED) {
+      return; // continued already, or the request failed meanwhile
+    }
+
+    heldBy = NO_HOLDER;
+
+    then(*this, connection->response, [this, position]() {
+      advanceFrom(position);
+    });
+
+    continueChain();
+  }
+
+  /**
+   * @brief Hands the request and response to another thread for middleware that deferred. `start` runs
+   * on the connection's thread once it is done with them, until the continuation is called nothing else
+   * touches the connection and responses are queued without writing to the socket.
+   * 
+   * @param start Passes the request on, eg. by submitting a job to a pool
+   */
+  void LGRequest::lend(std::function<void(void)> start) {
+    connection->lendTo = std::move(start);
+    connection->lentPosition = heldBy;
+  }
+
+#ifdef LG_HAS_COROUTINES
+  /**
+   * @brief Keeps a coroutine handler that suspended. Until it finishes, the stack waits for it,
+   * unless it called `next` already.
+   * 
+   * @param task The handler's task
+   * @param position The entry of the route matches it was started for
+   */
+  void LGRequest::adoptTask(LGTask task, size_t position) {
+    if (task.done()) {
+      task.result();
+      return;
+    }
+
+    task.handle.promise().request = this;
+    task.handle.promise().position = position;
+
+    if (chainPosition == position) {
+      heldBy = position;
+    }
+
+    tasks.push_back(std::move(task));
+  }
+
+  // The coroutine handler started for `position` returned
+  void LGRequest::taskFinished(size_t position) {
+    if (heldBy == position) {
+      heldBy = NO_HOLDER;
+    }
+  }
+
+  /**
+   * @brief Resumes a coroutine waiting on the request or response, then moves the stack on if it let go.
+   * 
+   * @param handle The coroutine
+   */
+  void LGRequest::resume(std::coroutine_handle<> handle) {
+    handle.resume();
+    continueChain();
+  }
+
+  /**
+   * @brief Waits for the whole request body without blocking the connection's thread.
+   * 
+   * @return BodyAwaiter Gives `body()` once it is complete
+   */
+  LGRequest::BodyAwaiter LGRequest::receiveBody() {
+    return BodyAwaiter{this};
+  }
+#endif
+
+  /**
+   * @brief Finishes the request. If the middleware left it without a response, answers OPTIONS
+   * with the allowed methods, sends a 405 when the path only has routes for other methods,
+   * a 501 for unknown methods, and a 404 otherwise.
+   * 
+   */
+  void LGRequest::finish() {
+    LGResponse& res = connection->response;
+    state = LGRequestState::FINISHED;
+
+    if (res.headersSent) {
+      if (res.streaming && !res.waitingForDrain) {
+        res.end(); // nothing is left to continue the stream
+      }
+
+      return;
+    }
+
+    if (!connection->routeMatches.routeMatched) {
+      std::string_view routePath = std::string_view(path);
+      routePath = routePath.substr(0, routePath.find('?'));
+
+      uint32_t allowed = app->getRouter().allowedMethods(routePath);
+
+      if (allowed != 0) {
+        std::string allow;
+
+        for (size_t i = 0; i < LG_METHOD_COUNT; i++) {
+          if (!(allowed & (1u << i))) continue;
+
+          if (!allow.empty()) allow += ", ";
+          allow += methodName((LGMethod)i);
+        }
+
+        res.header("Allow", allow);
+
+        if (methodId == LGMethod::HTTP_OPTIONS) {
+          res.status(200).end(allow);
+        } else {
+          res.status(405).end("Method Not Allowed");
+        }
+
+        return;
+      }
+
+      if (methodId == LGMethod::HTTP_UNKNOWN) {
+        res.status(501).end("Not Implemented");
+        return;
+      }
+    }
+
+    res.status(404).end("Page Not Found!");
+  }
+
+  LGConnection::LGConnection(LGClientSocket socket, LandingGear* app)
+    : loop(nullptr),
+      workers(nullptr),
+      waiter(nullptr),
+      closed(false),
+      peerClosed(false),
+      readPaused(false),
+      corked(false),
+      timeout(LGTimeout::NONE),
+      timeoutRequest(0),
+      receiveTimeout(-1),
+      progressed(false),
+      arenaBuffer(new char[REQUEST_ARENA_SIZE]),
+      lent(false),
+      lentEvents(0),
+      lentPosition(0),
+      socket(socket),
+      app(app),
+      outputOffset(0),
+      outputSize(0),
+      arena(arenaBuffer.get(), REQUEST_ARENA_SIZE),
+      request(this),
+      response(this),
+      requestCount(0),
+      keepAlive(true) {
+    parser.maxHeaders = app->maxHeaderCount;
+    parser.maxLineLength = app->maxHeaderLineLength;
+    bodyReader.maxLineLength = app->maxHeaderLineLength;
+    response.app = app;
+
+    this->socket.setSendTimeout(std::max(app->writeTimeout, 0));
+  };
+  LGConnection::LGConnection(LGClientSocket socket, LandingGear* app, LGEventLoop* loop)
+    : loop(loop),
+      workers(nullptr),
+      waiter(nullptr),
+      closed(false),
+      peerClosed(false),
+      readPaused(false),
+      corked(false),
+      timeout(LGTimeout::NONE),
+      timeoutRequest(0),
+      receiveTimeout(-1),
+      progressed(false),
+      arenaBuffer(new char[REQUEST_ARENA_SIZE]),
+      lent(false),
+      lentEvents(0),
+      lentPosition(0),
+      socket(socket),
+      app(app),
+      outputOffset(0),
+      outputSize(0),
+      arena(arenaBuffer.get(), REQUEST_ARENA_SIZE),
+      request(this),
+      response(this),
+      requestCount(0),
+      keepAlive(true) {
+    parser.maxHeaders = app->maxHeaderCount;
+    parser.maxLineLength = app->maxHeaderLineLength;
+    bodyReader.maxLineLength = app->maxHeaderLineLength;
+    response.app = app;
+
+    timer.onExpire = [this]() {
+      timedOut(timeout);
+      onEvent(0); // writes the 408 or deletes the connection
+    };
+
+    updateTimer();
+  };
+  /**
+   * @brief A connection run in jobs on `workers`, which deletes itself once it is done. With a `waiter`,
+   * it gives up its worker whenever it waits on the client and the waiter submits it again once the client
+   * is ready or the timeout passed.
+   * 
+   */
+  LGConnection::LGConnection(LGClientSocket socket, LandingGear* app, LGWorkerPool* workers, LGEventLoop* waiter)
+    : LGConnection(socket, app) {
+    this->workers = workers;
+    this->waiter = waiter;
+
+#ifdef LG_HAS_EPOLL
+    timer.onExpire = [this]() {
+      this->waiter->remove(this->socket.getSocket());
+      this->workers->submit([this]() {
+        timedOut(timeout);
+        run();
+      });
+    };
+#endif
+  };
+
+  /**
+   * @brief Starts a fresh request on the connection, keeping any bytes already received for it.
+   * 
+   */
+  void LGConnection::nextRequest() {
+    requestCount++;
+
+    // Destroyed and rebuilt rather than assigned, a string that is assigned to keeps its buffer,
+    // which must not outlive the arena being rewound in one step
+    request.~LGRequest();
+    response.~LGResponse();
+
+    arena.release();
+
+    new (&request) LGRequest(this);
+    new (&response) LGResponse(this);
+    response.app = app;
+
+    parser.reset();
+  }
+
+  /**
+   * @brief Runs every request that can be completed with the data received so far.
+   * Pipelined requests are processed back to back and their responses are written
+   * together, in order, once the batch is done.
+   * 
+   */
+  void LGConnection::processRequests() {
+    corked = true;
+
+    while (!closed && request.getRequest() == LGRequestState::FINISHED) {
+      if (!keepAlive || response.streaming) {
+        break; // a streamed response is ended from "drain" before the next request is read
+      }
+
+      nextRequest();
+
+      // Don't let a deep pipeline pile up responses, and stop reading requests while the client isn't reading responses.
+      if (outputSize >= PIPELINE_FLUSH_SIZE && !flush()) {
+        break;
+      }
+    }
+
+    corked = false;
+    flush();
+  }
+
+  /**
+   * @brief Writes data to the client. Copies the data, use `writeBuffers` for large payloads.
+   * 
+   * @param data The data to be sent
+   * @param size The amount of bytes
+   * @return int The amount of bytes accepted, -1 if the connection is broken
+   */
+  int LGConnection::write(const char* data, size_t size) {
+    std::string buffer = std::string(data, size);
+
+    return writeBuffers(&buffer, 1);
+  }
+
+  /**
+   * @brief Writes several buffers to the client with as few sends as possible. Buffers the socket
+   * does not take right away are moved into `output`, never copied, and written once the socket
+   * is writable again.
+   * 
+   * @param buffers The buffers to be sent, in order. Left in an unspecified state
+   * @param count The amount of buffers
+   * @return int The amount of bytes accepted, -1 if the connection is broken
+   */
+  int LGConnection::writeBuffers(std::string* buffers, size_t count) {
+    if (closed) return -1;
+
+    size_t total = 0;
+    for (size_t i = 0; i < count; i++) {
+      total += buffers[i].size();
+    }
+
+    if (corked || !output.empty()) {
+      queue(buffers, count, 0);
+      return total;
+    }
+
+    LGSendBuffer vectors[LG_MAX_SEND_BUFFERS];
+    size_t first = 0; // first buffer that has not been fully sent
+    size_t offset = 0; // bytes of the first buffer already sent
+
+    while (first < count) {
+      size_t vectorCount = 0;
+
+      for (size_t i = first; i < count && vectorCount < LG_MAX_SEND_BUFFERS; i++) {
+        size_t skip = i == first ? offset : 0;
+        vectors[vectorCount++] = LGSendBuffer{buffers[i].data() + skip, buffers[i].size() - skip};
+      }
+
+      int bytes = socket.sendv(vectors, vectorCount);
+
+      if (bytes < 0) {
+        if (loop != nullptr && socket.wouldBlock()) break;
+        return -1;
+      }
+
+      size_t sent = bytes;
+
+      // Short writes may end anywhere, even inside a buffer
+      while (first < count && sent >= buffers[first].size() - offset) {
+        sent -= buffers[first].size() - offset;
+        first++;
+        offset = 0;
+      }
+
+      offset += sent;
+    }
+
+    if (first < count) {
+      queue(buffers + first, count - first, offset);
+    }
+
+    return total;
+  }
+
+  /**
+   * @brief Writes a head followed by part of a file. The file is queued behind any pending output
+   * and sent with sendfile where available.
+   * 
+   * @param head The status line and headers
+   * @param file The file, kept open until it has been sent
+   * @param offset The first byte of the file to send
+   * @param length The amount of bytes to send
+   * @return int The amount of head bytes accepted, -1 if the connection is broken
+   */
+  int LGConnection::writeFile(std::string head, std::shared_ptr<LGFile> file, uint64_t offset, uint64_t length) {
+    LGOutputBuffer body;
+    body.file = std::move(file);
+    body.fileOffset = offset;
+    body.fileLength = length;
+
+    return append(std::move(head), std::move(body));
+  }
+
+  /**
+   * @brief Writes a head followed by a buffer shared with a cache. The buffer is referenced, not copied.
+   * 
+   * @param head The status line and headers
+   * @param data The shared data, kept alive until it has been sent
+   * @return int The amount of head bytes accepted, -1 if the connection is broken
+   */
+  int LGConnection::writeShared(std::string head, std::shared_ptr<const std::string> data) {
+    LGOutputBuffer body;
+    body.shared = std::move(data);
+
+    return append(std::move(head), std::move(body));
+  }
+
+  /**
+   * @brief Writes a head followed by data produced on a pool. The data keeps its place in the output,
+   * anything written after it waits until it is ready. Without an event loop it is produced right away.
+   * 
+   * @param head The status line and headers, or any bytes that can go out now
+   * @param pool The pool to run `produce` on
+   * @param produce Returns the data, runs on a pool thread
+   * @return int The amount of head bytes accepted, -1 if the connection is broken
+   */
+  int LGConnection::writeDeferred(std::string head, LGWorkerPool& pool, std::function<std::string(void)> produce) {
+    if (closed) return -1;
+
+#ifdef LG_HAS_EPOLL
+    if (loop != nullptr && !lent) { // a lent response is already produced away from the loop
+      std::shared_ptr<LGDeferredOutput> deferred = std::make_shared<LGDeferredOutput>();
+      deferred->connection = this;
+
+      size_t headSize = head.size();
+      queue(&head, 1, 0);
+
+      LGOutputBuffer body;
+      body.deferred = deferred;
+      output.push_back(std::move(body));
+
+      // The data is handed back on the connection's loop, which is the only thread that touches `deferred`
+      pool.submit([deferred, loop = loop, produce = std::move(produce)]() {
+        std::string data = produce();
+
+        loop->post([deferred, data = std::move(data)]() mutable {
+          if (deferred->connection != nullptr) {
+            deferred->connection->completeDeferred(deferred.get(), std::move(data));
+          }
+        });
+      });
+
+      if (!corked) {
+        flush();
+      }
+
+      return closed ? -1 : headSize;
+    }
+#endif
+
+    size_t headSize = head.size();
+    std::string buffers[2] = {std::move(head), produce()};
+
+    return writeBuffers(buffers, 2) < 0 ? -1 : headSize;
+  }
+
+  /**
+   * @brief Fills in a deferred buffer once its data is ready and writes it, with anything that waited behind it.
+   * May delete the connection.
+   * 
+   * @param deferred The buffer's place in `output`
+   * @param data The data
+   */
+  void LGConnection::completeDeferred(LGDeferredOutput* deferred, std::string data) {
+    for (auto buffer = output.begin(); buffer != output.end(); ++buffer) {
+      if (buffer->deferred.get() != deferred) continue;
+
+      if (data.empty()) {
+        output.erase(buffer);
+      } else {
+        outputSize += data.size();
+        buffer->data = std::move(data);
+        buffer->deferred.reset();
+      }
+
+      break;
+    }
+
+    onEvent(LG_POLL_WRITE);
+  }
+
+  /**
+   * @brief The place continuations of deferred middleware are handed to, created on first use.
+   * 
+   * @return std::shared_ptr<LGParking> Shared with the continuations
+   */
+  std::shared_ptr<LGParking> LGConnection::getParking() {
+    if (parking == nullptr) {
+      parking = std::make_shared<LGParking>();
+      parking->connection = this;
+      parking->loop = loop;
+      parking->workers = workers;
+      parking->parked = false;
+    }
+
+    return parking;
+  }
+
+  /**
+   * @brief Continues a deferred middleware on the connection's thread, unless the request is over.
+   * With an event loop, goes on with the connection afterwards and may delete it.
+   * 
+   */
+  void LGConnection::resumeDeferred(unsigned int requestNumber, size_t position, const LGMiddlewareCB& then) {
+    if (lent) {
+      if (requestNumber != requestCount || position != lentPosition) {
+        return; // the request is still used on another thread
+      }
+
+      lent = false;
+      corked = false;
+    }
+
+    if (requestNumber == requestCount && !closed) {
+      request.continueDeferred(position, then);
+    }
+
+    if (loop == nullptr) {
+      return; // run() goes on with the connection
+    }
+
+    processRequests(); // the request may be done, answer the ones pipelined behind it
+    onEvent(LG_POLL_WRITE | std::exchange(lentEvents, 0));
+  }
+
+  /**
+   * @brief Waits until deferred middleware of a blocking connection is continued, then runs the continuations.
+   * A connection run by `workers` gives up its worker instead, the first continuation submits it again.
+   * 
+   * @return true - Continuations ran
+   * @return false - The connection is parked, its thread must not touch it anymore
+   */
+  bool LGConnection::runParked() {
+    std::shared_ptr<LGParking> parking = getParking();
+    std::vector<std::function<void(void)>> jobs;
+
+    if (lendTo) {
+      lend();
+    }
+
+    {
+      std::unique_lock<std::mutex> hold(parking->lock);
+
+      if (workers != nullptr && parking->jobs.empty()) {
+        parking->parked = true;
+        return false;
+      }
+
+      parking->ready.wait(hold, [&parking]() { return !parking->jobs.empty(); });
+      jobs.swap(parking->jobs);
+    }
+
+    for (std::function<void(void)>& job : jobs) {
+      job();
+    }
+
+    return true;
+  }
+
+  /**
+   * @brief Passes the request to whatever `LGRequest::lend` was given. Only called while the connection's
+   * thread is done with the request and no output is being produced elsewhere.
+   * 
+   */
+  void LGConnection::lend() {
+    std::function<void(void)> start = std::move(lendTo);
+    lendTo = nullptr;
+
+    lent = true;
+    corked = true; // the socket is only written once the request is back
+
+    start();
+  }
+
+  LGDeferredNext::LGDeferredNext(std::shared_ptr<LGParking> parking, unsigned int requestNumber, size_t position)
+    : parking(std::move(parking)),
+      requestNumber(requestNumber),
+      position(position) {};
+
+  /**
+   * @brief Moves on to the next middleware.
+   * 
+   */
+  void LGDeferredNext::operator()() const {
+    (*this)([](LGRequest&, LGResponse&, NextFunction next) {
+      next();
+    });
+  }
+
+  /**
+   * @brief Runs a callback on the connection's thread in place of the deferred middleware.
+   * It can respond, call `next` or defer again.
+   * 
+   * @param then The callback
+   */
+  void LGDeferredNext::operator()(LGMiddlewareCB then) const {
+    std::shared_ptr<LGParking> parking = this->parking;
+
+    // `parking->connection` is only read on the connection's thread, which also clears it
+    std::function<void(void)> job = [parking, requestNumber = requestNumber, position = position, then = std::move(then)]() {
+      if (parking->connection != nullptr) {
+        parking->connection->resumeDeferred(requestNumber, position, then);
+      }
+    };
+
+#ifdef LG_HAS_EPOLL
+    if (parking->loop != nullptr) {
+      parking->loop->post(std::move(job));
+      return;
+    }
+#endif
+
+    std::lock_guard<std::mutex> hold(parking->lock);
+    parking->jobs.push_back(std::move(job));
+
+    if (parking->parked) {
+      parking->parked = false; // a parked connection can't close, `connection` is still set
+      LGConnection* connection = parking->connection;
+      parking->workers->submit([connection]() { connection->run(); });
+      return;
+    }
+
+    parking->ready.notify_one();
+  }
+
+  LGMiddlewareCB offload(ReqCallback cb) {
+    return offload(cb, LGOffloadOptions());
+  }
+
+  /**
+   * @brief Runs a route handler on a separate pool, so heavy work (eg. generating reports) doesn't hold up
+   * the thread serving the connection and the other connections sharing it. The handler gets the request and
+   * response like any other, nothing else touches them until it returns, and what it sends is written once it did.
+   * When `maxPending` requests of the route are already queued or running, others are answered with 503.
+   *
+   * With `streamBodies`, the handler runs before the body is in, it is read once the handler returned.
+   *
+   * Whatever the handler calls runs on the pool too, eg. body filters such as `compress` and "finish"
+   * listeners of the response. Middleware after it runs on the connection's thread again. In thread mode
+   * the connection's worker is given back to the server's pool while the handler runs, like with an event loop.
+   *
+   * @param cb The handler, eg. (req, res) -> {}
+   * @param options Settings for the pool and the queue limit
+   * @return LGMiddlewareCB The middleware, eg. app.get("/report", offload(handler))
+   */
+  LGMiddlewareCB offload(ReqCallback cb, LGOffloadOptions options) {
+    if (!options.pool) {
+      options.pool = std::make_shared<LGWorkerPool>();
+      options.pool->start(options.threads);
+    }
+
+    std::shared_ptr<LGWorkerPool> pool = options.pool;
+    std::shared_ptr<std::atomic<size_t>> pending = std::make_shared<std::atomic<size_t>>(0);
+    size_t maxPending = options.maxPending;
+
+    return [cb, pool, pending, maxPending](LGRequest& req, LGResponse& res, NextFunction) {
+      if (pending->fetch_add(1) >= maxPending && maxPending > 0) {
+        pending->fetch_sub(1);
+        res.status(503).end("Service Unavailable");
+        return;
+      }
+
+      // Held until the handler ran, or dropped with the job if the connection closes before it is submitted
+      std::shared_ptr<void> slot(nullptr, [pending](void*) { pending->fetch_sub(1); });
+      LGDeferredNext resume = req.defer();
+
+      req.lend([cb, pool, slot, resume, &req, &res]() {
+        pool->submit([cb, slot, resume, &req, &res]() {
+          cb(req, res);
+
+          resume([](LGRequest&, LGResponse& response, NextFunction next) {
+            if (!response.headersSent) {
+              next();
+            }
+          });
+        });
+      });
+    };
+  }
+
+  /**
+   * @brief Queues a head and a file or shared buffer behind any pending output, then writes
+   * as much as the socket takes unless the connection is corked.
+   * 
+   */
+  int LGConnection::append(std::string head, LGOutputBuffer body) {
+    if (closed) return -1;
+
+    size_t headSize = head.size();
+    queue(&head, 1, 0);
+
+    if (body.size() > 0) {
+      outputSize += body.size();
+      output.push_back(std::move(body));
+    }
+
+    if (!corked) {
+      flush();
+    }
+
+    return closed ? -1 : headSize;
+  }
+
+  /**
+   * @brief Whether the buffer is a range of a file that has to be sent from the file system.
+   * 
+   */
+  bool LGOutputBuffer::unmappedFile() const {
+    return file && file->mappedData() == nullptr;
+  }
+
+  /**
+   * @brief The bytes of a buffer that isn't an unmapped file.
+   * 
+   */
+  std::string_view LGOutputBuffer::bytes() const {
+    if (deferred) return std::string_view();
+    if (file) return std::string_view(file->mappedData() + fileOffset, (size_t)fileLength);
+
+    return shared ? std::string_view(*shared) : std::string_view(data);
+  }
+
+  uint64_t LGOutputBuffer::size() const {
+    return file ? fileLength : bytes().size();
+  }
+
+  /**
+   * @brief Moves buffers to the end of `output`. Small buffers are appended to the last one
+   * instead, so a batch of small responses is still written with a few large sends.
+   * 
+   * @param buffers The buffers to queue
+   * @param count The amount of buffers
+   * @param offset Bytes of the first buffer that were already sent. Only used when `output` is empty
+   */
+  void LGConnection::queue(std::string* buffers, size_t count, size_t offset) {
+    for (size_t i = 0; i < count; i++) {
+      std::string& buffer = buffers[i];
+      size_t skip = i == 0 ? offset : 0;
+
+      if (buffer.size() == skip) continue;
+
+      outputSize += buffer.size() - skip;
+
+      if (!output.empty() && !output.back().file && !output.back().shared && !output.back().deferred && buffer.size() <= OUTPUT_COALESCE_SIZE
+        && output.back().data.size() + buffer.size() <= OUTPUT_COALESCE_LIMIT) {
+        output.back().data.append(buffer, skip, std::string::npos);
+        continue;
+      }
+
+      if (output.empty()) outputOffset = skip;
+
+      LGOutputBuffer queued;
+      queued.data = std::move(buffer);
+      output.push_back(std::move(queued));
+    }
+  }
+
+  /**
+   * @brief Drops written bytes from the front of `output`.
+   * 
+   * @param bytes The amount of bytes the socket took
+   */
+  void LGConnection::consume(uint64_t bytes) {
+    outputSize -= bytes;
+
+    while (bytes > 0) {
+      uint64_t left = output.front().size() - outputOffset;
+
+      if (bytes < left) {
+        outputOffset += bytes;
+        return;
+      }
+
+      bytes -= left;
+      output.pop_front();
+      outputOffset = 0;
+    }
+  }
+
+  /**
+   * @brief Writes as much of the pending output as the socket accepts.
+   * 
+   * @return true - Everything has been written
+   * @return false - Data is still pending or the connection broke
+   */
+  bool LGConnection::flush() {
+    LGSendBuffer vectors[LG_MAX_SEND_BUFFERS];
+
+    while (outputSize > 0 && !output.front().deferred) {
+      const LGOutputBuffer& front = output.front();
+      int bytes;
+
+      if (front.unmappedFile()) {
+        bytes = socket.sendFile(*front.file, front.fileOffset + outputOffset, front.fileLength - outputOffset);
+
+        if (bytes == 0) {
+          close(); // the file shrank while it was being sent, the promised length can't be delivered
+          break;
+        }
+      } else {
+        size_t vectorCount = 0;
+        size_t gathered = 0;
+
+        // Gather the byte buffers and mapped files up to the next unmapped file or deferred buffer, at most what one send can report
+        for (auto buffer = output.begin(); buffer != output.end() && !buffer->unmappedFile() && !buffer->deferred && vectorCount < LG_MAX_SEND_BUFFERS
+          && gathered < OUTPUT_GATHER_LIMIT; ++buffer) {
+          std::string_view bytes = buffer->bytes();
+          size_t skip = vectorCount == 0 ? outputOffset : 0;
+          size_t amount = std::min(bytes.size() - skip, OUTPUT_GATHER_LIMIT - gathered);
+
+          vectors[vectorCount++] = LGSendBuffer{bytes.data() + skip, amount};
+          gathered += amount;
+        }
+
+        bytes = socket.sendv(vectors, vectorCount);
+      }
+
+      if (bytes < 0) {
+        if (loop == nullptr || !socket.wouldBlock()) close(); // a blocking send only fails like that once the write timeout passed
+        break;
+      }
+
+      consume(bytes);
+      progressed = true;
+    }
+
+    return output.empty() && !closed;
+  }
+
+  /**
+   * @brief Reads everything the non-blocking socket has available into `input`, up to `inputLimit`.
+   * 
+   * @return true - The connection is still open
+   * @return false - The client closed the connection or it errored
+   */
+  bool LGConnection::readAvailable() {
+    char buffer[4096];
+    size_t limit = inputLimit();
+
+    readPaused = false;
+
+    while (input.size() < limit) {
+      int bytes = socket.receive(buffer, sizeof(buffer));
+
+      if (bytes > 0) {
+        input.append(buffer, bytes);
+        progressed = true;
+        continue;
+      }
+
+      return bytes < 0 && socket.wouldBlock();
+    }
+
+    readPaused = true; // the rest waits in the socket, readiness for it won't be reported again
+    return true;
+  }
+
+  /**
+   * @brief The most a connection buffers of what the client sent. Enough for the largest head the
+   * parser accepts, bodies and pipelined requests beyond that wait in the socket while nothing consumes them.
+   * 
+   * @return size_t The limit in bytes
+   */
+  size_t LGConnection::inputLimit() const {
+    return (app->maxHeaderCount + 1) * (app->maxHeaderLineLength + 2) + INPUT_BODY_ALLOWANCE;
+  }
+
+  void LGConnection::close() {
+    if (closed) return;
+    closed = true;
+
+    for (LGOutputBuffer& buffer : output) {
+      if (buffer.deferred) buffer.deferred->connection = nullptr; // whatever is still being produced is dropped
+    }
+
+    if (parking != nullptr) {
+      parking->connection = nullptr; // so are continuations of deferred middleware
+    }
+
+#ifdef LG_HAS_EPOLL
+    if (loop != nullptr) {
+      loop->remove(socket.getSocket());
+    }
+#endif
+
+    socket.close();
+  }
+
+  /**
+   * @brief Processes the connection with blocking reads until the client or a response
+   * ends it, or the client takes longer than one of the timeouts. Run by `workers`, returns
+   * while deferred middleware is pending, and with a waiter whenever there is nothing to read.
+   * It goes on in a later job.
+   * 
+   */
+  void LGConnection::run() {
+    char buffer[4096];
+
+    while (true) {
+      if (lent) { // the request is used on another thread until a continuation gives it back
+        if (!runParked()) return;
+        continue;
+      }
+
+      processRequests();
+
+      if (closed || (request.state == LGRequestState::FINISHED && !keepAlive)) {
+        break;
+      }
+
+      if (request.state == LGRequestState::WAITING || lendTo) { // nothing to read until deferred middleware is done
+        if (!runParked()) return;
+        continue;
+      }
+
+      // Heads and bodies are consumed as they arrive, this much only piles up behind a streamed response that isn't ended
+      if (input.size() >= inputLimit()) {
+        break;
+      }
+
+      // Receives wait as long as the current timeout allows, headers only as long as is left of theirs
+      LGTimeout kind = pendingTimeout();
+      int wait = timeoutLength(kind);
+
+      if (kind == LGTimeout::HEADERS && wait > 0) {
+        std::chrono::steady_clock::time_point now = std::chrono::steady_clock::now();
+
+        if (timeout != LGTimeout::HEADERS || timeoutRequest != requestCount) {
+          headersDue = now + std::chrono::milliseconds(wait);
+        }
+
+        wait = (int)std::chrono::ceil<std::chrono::milliseconds>(headersDue - now).count();
+      }
+
+      timeout = kind;
+      timeoutRequest = requestCount;
+
+      if (wait <= 0 && timeoutLength(kind) > 0) {
+        timedOut(kind);
+        continue;
+      }
+
+#ifdef LG_HAS_EPOLL
+      if (waiter != nullptr) {
+        int bytes = socket.receive(buffer, sizeof(buffer), MSG_DONTWAIT);
+
+        if (bytes > 0) {
+          input.append(buffer, bytes);
+          continue;
+        }
+
+        if (bytes < 0 && socket.wouldBlock()) {
+          await(wait);
+          return;
+        }
+
+        break;
+      }
+#endif
+
+      // Without a waiter every idle connection holds a worker, one that waits for its next request gives way to queued connections
+      if (kind == LGTimeout::IDLE && workers != nullptr && workers->queued() > 0) {
+        break;
+      }
+
+      // Only changed along with the timeout, so a head that trickles in is caught by the deadline check
+      // above and may take up to one more `headerTimeout` to be answered
+      int length = std::max(timeoutLength(kind), 0);
+
+      if (length != receiveTimeout) {
+        socket.setReceiveTimeout(length);
+        receiveTimeout = length;
+      }
+
+      int bytes = socket.receive(buffer, sizeof(buffer));
+
+      if (bytes < 0 && length > 0 && socket.timedOut()) {
+        timedOut(kind);
+        continue;
+      }
+
+      if (bytes <= 0) {
+        break;
+      }
+
+      input.append(buffer, bytes);
+    }
+
+    close();
+
+    if (workers != nullptr) {
+      delete this;
+    }
+  }
+
+  /**
+   * @brief Hands the connection to the waiter until the client sends something or `milliseconds` passed,
+   * the waiter then submits it to the workers again. Nothing touches the connection meanwhile.
+   * 
+   * @param milliseconds How long the client has, 0 or less when unlimited
+   */
+  void LGConnection::await(int milliseconds) {
+#ifdef LG_HAS_EPOLL
+    waiter->post([this, milliseconds]() {
+      if (waiter->add(socket.getSocket(), this, LG_POLL_READ)) {
+        close();
+        delete this;
+        return;
+      }
+
+      if (milliseconds > 0) {
+        waiter->schedule(timer, milliseconds);
+      }
+    });
+#endif
+  }
+
+  /**
+   * @brief Advances the connection when the event loop reports readiness.
+   * Deletes the connection once it is done with.
+   * 
+   * @param events The LGPollEvent flags
+   */
+  void LGConnection::onEvent(int events) {
+#ifdef LG_HAS_EPOLL
+    if (waiter != nullptr) { // the client of a waiting connection is ready, it goes back to the workers
+      waiter->remove(socket.getSocket());
+      timer.cancel();
+      workers->submit([this]() { run(); });
+      return;
+    }
+#endif
+
+    if (lent) {
+      lentEvents |= events; // handled once the request is back
+      return;
+    }
+
+    if (events & (LG_POLL_READ | LG_POLL_HANGUP)) { // a hangup may leave data to read, the read then sees the close
+      if (!readAvailable()) {
+        peerClosed = true;
+      }
+
+      processRequests();
+    }
+
+    if ((events & LG_POLL_WRITE) && outputSize > 0 && flush()) {
+      processRequests(); // pick up pipelined requests that waited for the client to read
+    }
+
+    if (response.waitingForDrain && !closed && outputSize < app->highWaterMark) {
+      response.waitingForDrain = false;
+      response.emit("drain", EventData(EventType::CHUNK));
+
+#ifdef LG_HAS_COROUTINES
+      if (response.drainWaiter) {
+        request.resume(std::exchange(response.drainWaiter, nullptr)); // a coroutine in `co_await res.write(...)`
+      }
+#endif
+
+      if (response.streaming && !response.waitingForDrain && request.state == LGRequestState::FINISHED) {
+        response.end(); // nothing is left to continue the stream
+      }
+
+      processRequests();
+    }
+
+    // Reading stopped at the input limit, go on with what the socket kept once the requests made room
+    while (readPaused && !closed && input.size() < inputLimit()) {
+      if (!readAvailable()) {
+        peerClosed = true;
+      }
+
+      processRequests();
+    }
+
+    bool finished = request.state == LGRequestState::FINISHED && !keepAlive;
+    bool abandoned = peerClosed && request.state != LGRequestState::WAITING; // a waiting response can still be delivered
+
+    if (closed || ((finished || abandoned) && output.empty())) {
+      close();
+      delete this;
+      return;
+    }
+
+    bool producing = std::any_of(output.begin(), output.end(), [](const LGOutputBuffer& buffer) { return buffer.deferred != nullptr; });
+
+    if (lendTo && !producing) {
+      lend();
+    }
+
+    updateTimer();
+  }
+
+  /**
+   * @brief What the connection waits on the client for, if anything.
+   * 
+   * @return LGTimeout The timeout that applies
+   */
+  LGTimeout LGConnection::pendingTimeout() const {
+    if (lent || request.state == LGRequestState::WAITING) {
+      return LGTimeout::NONE;
+    }
+
+    if (!output.empty()) {
+      return output.front().deferred ? LGTimeout::NONE : LGTimeout::WRITE;
+    }
+
+    switch (request.state) {
+      case LGRequestState::HEADERS:
+        return input.empty() && requestCount > 0 ? LGTimeout::IDLE : LGTimeout::HEADERS;
+      case LGRequestState::BODY:
+        return LGTimeout::BODY;
+      default:
+        return LGTimeout::NONE; // a streamed response the application is still writing
+    }
+  }
+
+  /**
+   * @brief The configured length of a timeout.
+   * 
+   * @param kind The timeout
+   * @return int Milliseconds, 0 or less when unlimited
+   */
+  int LGConnection::timeoutLength(LGTimeout kind) const {
+    switch (kind) {
+      case LGTimeout::IDLE: return app->keepAliveTimeout;
+      case LGTimeout::HEADERS: return app->headerTimeout;
+      case LGTimeout::BODY: return app->bodyTimeout;
+      case LGTimeout::WRITE: return app->writeTimeout;
+      default: return 0;
+    }
+  }
+
+  /**
+   * @brief Starts the timer over when the connection waits on something else, a new request, or on
+   * a body or write that made progress. Headers have to arrive in time as a whole.
+   * 
+   */
+  void LGConnection::updateTimer() {
+    if (loop == nullptr) {
+      return; // run() times out its blocking calls
+    }
+
+    LGTimeout kind = pendingTimeout();
+    bool restart = kind != timeout || requestCount != timeoutRequest
+      || (progressed && (kind == LGTimeout::BODY || kind == LGTimeout::WRITE));
+
+    progressed = false;
+
+    if (!restart) {
+      return;
+    }
+
+    timeout = kind;
+    timeoutRequest = requestCount;
+
+    int milliseconds = timeoutLength(kind);
+
+#ifdef LG_HAS_EPOLL
+    if (milliseconds > 0) {
+      loop->schedule(timer, milliseconds);
+      return;
+    }
+#endif
+
+    timer.cancel();
+  }
+
+  /**
+   * @brief Gives up on a client that took too long. Partial requests are answered with 408
+   * and the connection is closed once that is written, otherwise it is closed right away.
+   * 
+   * @param kind What the connection waited for
+   */
+  void LGConnection::timedOut(LGTimeout kind) {
+    bool partial = kind == LGTimeout::BODY || (kind == LGTimeout::HEADERS && !input.empty());
+
+    if (partial && !response.headersSent) {
+      request.fail(408);
+      flush();
+    } else {
+      close();
+    }
+  }
+
+  LGMiddleware::LGMiddleware() {};
+  LGMiddleware::LGMiddleware(std::string path): path(path) {};
+  LGMiddleware::LGMiddleware(std::string path, const char* method): path(path), method(method) {};
+  LGMiddleware::LGMiddleware(std::string path, bool isWildcard): path(path), isWildcard(isWildcard) {};
+  LGMiddleware::LGMiddleware(LGMiddlewareCB cb): cb(cb) {};
+  LGMiddleware::LGMiddleware(LGMiddlewareCB cb, std::string method): cb(cb), method(method) {};
+
+  LGMiddleware::LGMiddleware(std::string path, const char* method, LGMiddlewareCB cb)
+    : path(path),
+      method(method),
+      cb(cb) {};
+  LGMiddleware::LGMiddleware(std::string path, const char* method, ReqCallback cb)
+    : path(path),
+      method(method) {
+    this->cb = [cb](LGRequest& req, LGResponse& res, NextFunction next) {
       cb(req, res);
       if (!res.headersSent) {
         next();
       }
     };
+  }
 
-    middleware.push_back(middlew);
+  // Calls the callback (cb)
+  void LGMiddleware::call(LGRequest& req, LGResponse& res, const NextFunction& next) const {
+    cb(req, res, next);
   }
-  void LandingGear::get(std::string path, LGMiddlewareCB cb) {
-    LGMiddleware middlew = LGMiddleware(path, "GET");
-    middlew.cb = cb;
 
-    middleware.push_back(middlew);
+  LandingGear::LandingGear()
+    : frozen(false),
+      workers(0),
+      mode(LGServerMode::THREADS),
+      keepAliveTimeout(5000),
+      headerTimeout(10000),
+      bodyTimeout(10000),
+      writeTimeout(30000),
+      maxRequestsPerConnection(1000),
+      maxHeaderCount(100),
+      maxHeaderLineLength(8192),
+      maxBodySize(1024 * 1024),
+      highWaterMark(64 * 1024),
+      streamBodies(false) {
+    socket = LGServerSocket();
   }
-  void LandingGear::get(std::string path, LGMiddlewareCB middle, LGMiddlewareCB cb) {
-    LGMiddleware middlew = LGMiddleware(path, "GET");
-    middlew.cb = [&](LGRequest& req, LGResponse& res, NextFunction next) {
-      middle(req, res, [&]() {
-        cb(req, res, next);
-      });
-    };
+
+  /**
+   * @brief Pushes onto the middleware stack. Refused once the server is listening
+   * since the workers read the stack without locking.
+   *
+   * @param middlew The middleware to add
+   */
+  void LandingGear::addMiddleware(LGMiddleware middlew) {
+    if (frozen) {
+      std::cerr << "Cannot add middleware to " << middlew.path << " after listen has been called!" << std::endl;
+      return;
+    }
+
+    if (middlew.method == "USE") {
+      router.mount(middlew.path, middleware.size());
+    } else if (middlew.method == "ALL") {
+      router.addAny(middlew.path, middleware.size());
+    } else {
+      LGMethod method = parseMethod(middlew.method);
+
+      if (method == LGMethod::HTTP_UNKNOWN) {
+        std::cerr << "Cannot add middleware to " << middlew.path << ", unknown method " << middlew.method << "!" << std::endl;
+        return;
+      }
+
+      router.add(middlew.path, method, middleware.size());
+    }
 
     middleware.push_back(middlew);
   }
-  void LandingGear::get(std::string path, LGMiddlewareCB middle, ReqCallback cb) {
-    LGMiddleware middlew = LGMiddleware(path, "GET");
-    middlew.cb = [&](LGRequest& req, LGResponse& res, NextFunction next) {
-      middle(req, res, [&]() {
-        cb(req, res);
 
-        if (!res.headersSent) {
-          next();
-        }
-      });
+  const LGRouter& LandingGear::getRouter() const {
+    return router;
+  }
+
+  /**
+   * @brief Adds a route for a method. `app.get(path, cb)` is `app.route("GET", path, cb)`.
+   *
+   * @param method The HTTP method (eg. "POST"), or "ALL" for every method
+   * @param path The route pattern (eg. "/home/:id")
+   * @param cb The handler
+   */
+  void LandingGear::route(std::string method, std::string path, ReqCallback cb) {
+    LGMiddleware middlew = LGMiddleware(path, method.c_str());
+    middlew.cb = [cb](LGRequest& req, LGResponse& res, NextFunction next) {
+      cb(req, res);
+      if (!res.headersSent) {
+        next();
+      }
     };
 
-    middleware.push_back(middlew);
+    addMiddleware(middlew);
   }
+  void LandingGear::route(std::string method, std::string path, LGMiddlewareCB cb) {
+    LGMiddleware middlew = LGMiddleware(path, method.c_str());
+    middlew.cb = cb;
+
+    addMiddleware(middlew);
+  }
+  // The route middleware and the handler are registered as two consecutive entries of the stack,
+  // so the middleware's next() runs the handler without building a closure per request.
+  void LandingGear::route(std::string method, std::string path, LGMiddlewareCB middle, LGMiddlewareCB cb) {
+    route(method, path, middle);
+    route(method, path, cb);
+  }
+  void LandingGear::route(std::string method, std::string path, LGMiddlewareCB middle, ReqCallback cb) {
+    route(method, path, middle);
+    route(method, path, cb);
+  }
+
+  void LandingGear::get(std::string path, ReqCallback cb) { route("GET", path, cb); }
+  void LandingGear::get(std::string path, LGMiddlewareCB cb) { route("GET", path, cb); }
+  void LandingGear::get(std::string path, LGMiddlewareCB middle, LGMiddlewareCB cb) { route("GET", path, middle, cb); }
+  void LandingGear::get(std::string path, LGMiddlewareCB middle, ReqCallback cb) { route("GET", path, middle, cb); }
+
+  void LandingGear::post(std::string path, ReqCallback cb) { route("POST", path, cb); }
+  void LandingGear::post(std::string path, LGMiddlewareCB cb) { route("POST", path, cb); }
+  void LandingGear::post(std::string path, LGMiddlewareCB middle, LGMiddlewareCB cb) { route("POST", path, middle, cb); }
+  void LandingGear::post(std::string path, LGMiddlewareCB middle, ReqCallback cb) { route("POST", path, middle, cb); }
+
+  void LandingGear::put(std::string path, ReqCallback cb) { route("PUT", path, cb); }
+  void LandingGear::put(std::string path, LGMiddlewareCB cb) { route("PUT", path, cb); }
+  void LandingGear::put(std::string path, LGMiddlewareCB middle, LGMiddlewareCB cb) { route("PUT", path, middle, cb); }
+  void LandingGear::put(std::string path, LGMiddlewareCB middle, ReqCallback cb) { route("PUT", path, middle, cb); }
+
+  void LandingGear::del(std::string path, ReqCallback cb) { route("DELETE", path, cb); }
+  void LandingGear::del(std::string path, LGMiddlewareCB cb) { route("DELETE", path, cb); }
+  void LandingGear::del(std::string path, LGMiddlewareCB middle, LGMiddlewareCB cb) { route("DELETE", path, middle, cb); }
+  void LandingGear::del(std::string path, LGMiddlewareCB middle, ReqCallback cb) { route("DELETE", path, middle, cb); }
+
+  void LandingGear::patch(std::string path, ReqCallback cb) { route("PATCH", path, cb); }
+  void LandingGear::patch(std::string path, LGMiddlewareCB cb) { route("PATCH", path, cb); }
+  void LandingGear::patch(std::string path, LGMiddlewareCB middle, LGMiddlewareCB cb) { route("PATCH", path, middle, cb); }
+  void LandingGear::patch(std::string path, LGMiddlewareCB middle, ReqCallback cb) { route("PATCH", path, middle, cb); }
+
+  void LandingGear::head(std::string path, ReqCallback cb) { route("HEAD", path, cb); }
+  void LandingGear::head(std::string path, LGMiddlewareCB cb) { route("HEAD", path, cb); }
+  void LandingGear::head(std::string path, LGMiddlewareCB middle, LGMiddlewareCB cb) { route("HEAD", path, middle, cb); }
+  void LandingGear::head(std::string path, LGMiddlewareCB middle, ReqCallback cb) { route("HEAD", path, middle, cb); }
+
+  void LandingGear::options(std::string path, ReqCallback cb) { route("OPTIONS", path, cb); }
+  void LandingGear::options(std::string path, LGMiddlewareCB cb) { route("OPTIONS", path, cb); }
+  void LandingGear::options(std::string path, LGMiddlewareCB middle, LGMiddlewareCB cb) { route("OPTIONS", path, middle, cb); }
+  void LandingGear::options(std::string path, LGMiddlewareCB middle, ReqCallback cb) { route("OPTIONS", path, middle, cb); }
+
+  void LandingGear::all(std::string path, ReqCallback cb) { route("ALL", path, cb); }
+  void LandingGear::all(std::string path, LGMiddlewareCB cb) { route("ALL", path, cb); }
+  void LandingGear::all(std::string path, LGMiddlewareCB middle, LGMiddlewareCB cb) { route("ALL", path, middle, cb); }
+  void LandingGear::all(std::string path, LGMiddlewareCB middle, ReqCallback cb) { route("ALL", path, middle, cb); }
 
   void LandingGear::use(std::string path, LGMiddlewareCB cb) {
     LGMiddleware middlew = LGMiddleware(path, "USE");
     middlew.cb = cb;
 
-    middleware.push_back(middlew);
+    addMiddleware(middlew);
   }
 
   int LandingGear::listen(int port, ListenCB cb) {
@@ -699,77 +2885,190 @@ namespace LandingGear {
    */
   int LandingGear::listen(int port) {
     socket.port = port;
-    socket.initSocket();
+    frozen = true;
+
+    if (mode == LGServerMode::EVENT_LOOP) {
+#ifdef LG_HAS_EPOLL
+      return listenEventLoop();
+#else
+      std::cerr << "The event loop mode is not supported on this platform, using worker threads!" << std::endl;
+#endif
+    }
 
-    socket.listen();
+    return listenThreads();
+  }
+
+  /**
+   * @brief Connections are accepted on one thread and processed with blocking
+   * sockets by a pool of `workers` threads. On Linux a connection gives up its worker while it
+   * waits on the client, one epoll loop watches all of those and submits them again once they are ready.
+   * 
+   * @return int Status code: 1 - Failure, 0 - Success
+   */
+  int LandingGear::listenThreads() {
+    if (socket.initSocket() || socket.listen()) {
+      return 1;
+    }
+
+    pool.start(workers);
 
-    bool serverRunning = false;
+    LGEventLoop* connectionWaiter = nullptr;
+    std::thread waiterThread;
+
+#ifdef LG_HAS_EPOLL
+    waiter = std::unique_ptr<LGEventLoop>(new LGEventLoop());
+
+    if (waiter->init()) {
+      waiter.reset(); // connections block in their receives instead
+    } else {
+      connectionWaiter = waiter.get();
+      waiterThread = std::thread([connectionWaiter]() {
+        connectionWaiter->run();
+      });
+    }
+#endif
 
     mainThread = std::thread([&](){
-      serverRunning = true;
       while (true) {
         LGClientSocket clientSocket = socket.accept();
 
         if (!clientSocket.isInit()) {
-          socket.close();
-          return 1;
+          if (socket.outOfResources()) {
+            std::this_thread::sleep_for(std::chrono::milliseconds(ACCEPT_RETRY_MS));
+            continue;
+          }
+
+          break;
         }
 
-        LGRequest req = LGRequest(clientSocket);
-        req.app = this;
-        
-        req.getRequest();
+        LGConnection* connection = new LGConnection(clientSocket, this, &pool, connectionWaiter);
+
+        pool.submit([connection]() {
+          connection->run();
+        });
       }
 
       socket.close();
-      serverRunning = false;
     });
 
     mainThread.join();
 
+    // The waiter submits to the pool, it has to be gone before the pool's queues are
+#ifdef LG_HAS_EPOLL
+    if (connectionWaiter != nullptr) {
+      connectionWaiter->stop();
+      waiterThread.join();
+    }
+#endif
+
+    pool.stop();
+
     return 0;
   }
 
-  LGMiddlewareCB getStatic(std::string folderpath) {
-    return [folderpath](LGRequest& req, LGResponse& res, NextFunction next) {
-      std::vector<std::string> paths = split(req.path, folderpath);
-      if (paths.size() <= 0) {
-        next();
-        return;
-      }
-      
-      std::string realPath = paths.size() > 1 ? paths[1] : paths[0];
+#ifdef LG_HAS_EPOLL
+  /**
+   * @brief Accepts every pending connection on a non-blocking server socket
+   * and registers them on the loop that owns the socket.
+   * 
+   */
+  class LGListener : public LGPollable {
+    public:
+    LGServerSocket socket;
+    LGEventLoop* loop;
+    LandingGear* app;
+    LGTimer retry; // accepts again after running out of descriptors, edge-triggered readiness won't be reported twice
+
+    LGListener() {
+      retry.onExpire = [this]() { onEvent(LG_POLL_READ); };
+    }
 
-      if (startsWith(realPath, "/")) {
-        realPath = realPath.substr(1);
-      }
+    void onEvent(int) override {
+      while (true) {
+        LGClientSocket clientSocket = socket.accept();
 
-      std::string folderPath = folderpath;
+        if (!clientSocket.isInit()) {
+          if (socket.wouldBlock()) {
+            return;
+          }
 
-      if (startsWith(folderPath, "/")) {
-        folderPath = folderPath.substr(1);
-      }
+          if (socket.outOfResources()) {
+            loop->schedule(retry, ACCEPT_RETRY_MS); // connections stay in the backlog until some close
+            return;
+          }
+
+          continue; // the client went away before it was accepted
+        }
+
+        if (clientSocket.setNonBlocking()) {
+          clientSocket.close();
+          continue;
+        }
+
+        LGConnection* connection = new LGConnection(clientSocket, app, loop);
 
-      if (endsWith(folderPath, "/")) {
-        folderPath = folderPath.substr(0, folderPath.size() - 1);
+        if (loop->add(clientSocket.getSocket(), connection)) {
+          clientSocket.close();
+          delete connection;
+        }
       }
+    }
+  };
+
+  /**
+   * @brief Runs one epoll loop per worker. Each loop owns its own listening socket bound
+   * with SO_REUSEPORT, so the kernel spreads new connections across the loops.
+   * 
+   * @return int Status code: 1 - Failure, 0 - Success
+   */
+  int LandingGear::listenEventLoop() {
+    unsigned int count = workers > 0 ? workers : std::max(1u, std::thread::hardware_concurrency());
 
-      std::ifstream File(folderPath + "/" + realPath);
+    std::vector<std::unique_ptr<LGEventLoop>> loops;
+    std::vector<std::unique_ptr<LGListener>> listeners;
 
-      if (!File.good() || File.eof() || File.bad() || File.fail()) {
-        File.close();
-        next();
-        return;
+    // The loops close their own descriptors once they are destroyed, the listening sockets are closed here
+    auto closeListeners = [&listeners]() {
+      for (auto& listener : listeners) {
+        listener->socket.close();
       }
-      
-      std::string line;
-      std::string data = "";
-      while (std::getline(File, line)) {
-        data += line;
+    };
+
+    for (unsigned int i = 0; i < count; i++) {
+      loops.push_back(std::unique_ptr<LGEventLoop>(new LGEventLoop()));
+      listeners.push_back(std::unique_ptr<LGListener>(new LGListener()));
+
+      LGEventLoop* loop = loops.back().get();
+      LGListener* listener = listeners.back().get();
+
+      listener->socket = LGServerSocket(socket.port);
+      listener->socket.reusePort = true;
+      listener->loop = loop;
+      listener->app = this;
+
+      if (listener->socket.initSocket() || listener->socket.setNonBlocking() || listener->socket.listen()
+        || loop->init() || loop->add(listener->socket.getSocket(), listener)) {
+        closeListeners();
+        return 1;
       }
+    }
 
-      res.send(data);
-      File.close();
-    };
+    std::vector<std::thread> threads;
+
+    for (auto& loop : loops) {
+      LGEventLoop* current = loop.get();
+      threads.push_back(std::thread([current]() {
+        current->run();
+      }));
+    }
+
+    for (std::thread& thread : threads) {
+      thread.join();
+    }
+
+    closeListeners();
+
+    return 0;
   }
+#endif
 };
\ No newline at end of file
@@ -0,0 +1,194 @@
+#include "RequestParser.h"
+#include "Scan.h"
+
+#include <cstring>
+
+namespace LandingGear {
+
+  static inline bool isBlank(char c) {
+    return c == ' ' || c == '\t';
+  }
+
+  // A character allowed in a header name (RFC 7230 "tchar")
+  static inline bool isTokenChar(char c) {
+    return (c >= 'a' && c <= 'z') || (c >= 'A' && c <= 'Z') || (c >= '0' && c <= '9') || (c != 0 && strchr("!#$%&'*+-.^_`|~", c) != nullptr);
+  }
+
+  static const char* methodNames[] = {
+    "GET", "HEAD", "POST", "PUT", "DELETE", "PATCH", "OPTIONS", "CONNECT", "TRACE",
+  };
+
+  /**
+   * @brief Converts a method token to its enum. Method names are case-sensitive.
+   *
+   * @param method The method (eg. "GET")
+   * @return LGMethod The method, HTTP_UNKNOWN if it isn't a standard method
+   */
+  LGMethod parseMethod(std::string_view method) {
+    for (size_t i = 0; i < LG_METHOD_COUNT; i++) {
+      if (method == methodNames[i]) return (LGMethod)i;
+    }
+
+    return LGMethod::HTTP_UNKNOWN;
+  }
+
+  /**
+   * @brief Converts a method enum to its name.
+   *
+   * @param method The method
+   * @return const char* The name (eg. "GET"), empty for HTTP_UNKNOWN
+   */
+  const char* methodName(LGMethod method) {
+    return method == LGMethod::HTTP_UNKNOWN ? "" : methodNames[(size_t)method];
+  }
+
+  LGRequestParser::LGRequestParser(): maxHeaders(100), maxLineLength(8192) {
+    reset();
+  };
+
+  /**
+   * @brief Prepares the parser for the next request. Keeps allocated storage around.
+   *
+   */
+  void LGRequestParser::reset() {
+    position = 0;
+    gotRequestLine = false;
+    errorCode = 0;
+    consumed = 0;
+
+    methodSpan = pathSpan = protocolSpan = Span{0, 0};
+    headerSpans.clear();
+
+    methodId = LGMethod::HTTP_UNKNOWN;
+    method = path = protocol = std::string_view();
+    headers.clear();
+  }
+
+  LGParseResult LGRequestParser::fail(int code) {
+    errorCode = code;
+    return LGParseResult::ERROR;
+  }
+
+  /**
+   * @brief Parses "METHOD /path HTTP/1.1".
+   *
+   * @return true - The line is valid
+   * @return false - The line is malformed
+   */
+  bool LGRequestParser::parseRequestLine(const char* data, size_t start, size_t end) {
+    const char* line = data + start;
+    const char* lineEnd = data + end;
+
+    const char* methodEnd = scanFor(line, lineEnd, ' ');
+    if (methodEnd == lineEnd || methodEnd == line) return false;
+
+    const char* pathStart = methodEnd + 1;
+    const char* pathEnd = scanFor(pathStart, lineEnd, ' ');
+    if (pathEnd == lineEnd || pathEnd == pathStart) return false;
+
+    const char* protocolStart = pathEnd + 1;
+    size_t protocolLength = lineEnd - protocolStart;
+    if (protocolLength < 6 || memcmp(protocolStart, "HTTP/", 5) != 0) return false;
+
+    methodSpan = Span{(uint32_t)start, (uint32_t)(methodEnd - line)};
+    pathSpan = Span{(uint32_t)(pathStart - data), (uint32_t)(pathEnd - pathStart)};
+    protocolSpan = Span{(uint32_t)(protocolStart - data), (uint32_t)protocolLength};
+
+    return true;
+  }
+
+  /**
+   * @brief Parses "Name: value", trimming whitespace around the value. Names must be tokens directly
+   * followed by the colon, a proxy may read "Name : value" differently (RFC 7230 3.2.4).
+   *
+   * @return true - The line is valid
+   * @return false - The line is malformed
+   */
+  bool LGRequestParser::parseHeaderLine(const char* data, size_t start, size_t end) {
+    if (isBlank(data[start])) return false; // obsolete line folding
+
+    const char* colon = scanFor(data + start, data + end, ':');
+    if (colon == data + end) return false;
+
+    size_t nameEnd = colon - data;
+    if (nameEnd == start) return false;
+
+    for (size_t i = start; i < nameEnd; i++) {
+      if (!isTokenChar(data[i])) return false;
+    }
+
+    size_t valueStart = skipBlanks(colon + 1, data + end) - data;
+    size_t valueEnd = end;
+    while (valueEnd > valueStart && isBlank(data[valueEnd - 1])) valueEnd--;
+
+    headerSpans.push_back(HeaderSpan{
+      Span{(uint32_t)start, (uint32_t)(nameEnd - start)},
+      Span{(uint32_t)valueStart, (uint32_t)(valueEnd - valueStart)},
+    });
+
+    return true;
+  }
+
+  /**
+   * @brief Continues parsing the request head. `data` must start at the same request every call,
+   * only more bytes may have been appended since the last call.
+   *
+   * @param data The receive buffer
+   * @param size The amount of bytes in the buffer
+   * @return LGParseResult Whether the head is complete, incomplete or invalid
+   */
+  LGParseResult LGRequestParser::parse(const char* data, size_t size) {
+    if (errorCode != 0) return LGParseResult::ERROR;
+
+    while (true) {
+      if (!gotRequestLine) {
+        // Tolerate blank lines before the request line
+        while (position < size && (isBlank(data[position]) || data[position] == '\r' || data[position] == '\n')) {
+          position++;
+        }
+      }
+
+      const char* newline = scanFor(data + position, data + size, '\n');
+
+      if (newline == data + size) {
+        if (size - position > maxLineLength) return fail(gotRequestLine ? 431 : 414);
+        return LGParseResult::INCOMPLETE;
+      }
+
+      size_t next = newline - data + 1;
+      size_t lineEnd = newline - data;
+      if (lineEnd > position && data[lineEnd - 1] == '\r') lineEnd--;
+
+      if (lineEnd - position > maxLineLength) return fail(gotRequestLine ? 431 : 414);
+
+      if (!gotRequestLine) {
+        if (!parseRequestLine(data, position, lineEnd)) return fail(400);
+        gotRequestLine = true;
+      } else if (lineEnd == position) {
+        consumed = next;
+        break;
+      } else {
+        if (headerSpans.size() >= maxHeaders) return fail(431);
+        if (!parseHeaderLine(data, position, lineEnd)) return fail(400);
+      }
+
+      position = next;
+    }
+
+    method = std::string_view(data + methodSpan.offset, methodSpan.length);
+    methodId = parseMethod(method);
+    path = std::string_view(data + pathSpan.offset, pathSpan.length);
+    protocol = std::string_view(data + protocolSpan.offset, protocolSpan.length);
+
+    headers.clear();
+    for (const HeaderSpan& header : headerSpans) {
+      headers.push_back(LGHeaderView{
+        std::string_view(data + header.name.offset, header.name.length),
+        std::string_view(data + header.value.offset, header.value.length),
+      });
+    }
+
+    return LGParseResult::COMPLETE;
+  }
+
+}; // namespace LandingGear
@@ -0,0 +1,215 @@
+#include "Router.h"
+
+#include <algorithm>
+
+namespace LandingGear {
+
+  /**
+   * @brief Splits the first segment off a path, ignoring empty segments.
+   *
+   * @param rest The path left to walk. Advanced past the segment.
+   * @return std::string_view The segment, empty if the path is exhausted
+   */
+  static std::string_view nextSegment(std::string_view& rest) {
+    size_t start = rest.find_first_not_of('/');
+
+    if (start == std::string_view::npos) {
+      rest = std::string_view();
+      return rest;
+    }
+
+    size_t end = rest.find('/', start);
+    if (end == std::string_view::npos) end = rest.size();
+
+    std::string_view segment = rest.substr(start, end - start);
+    rest.remove_prefix(end);
+
+    return segment;
+  }
+
+  void LGRouteMatches::clear() {
+    matches.clear();
+    values.clear();
+    captures.clear();
+    routeMatched = false;
+  }
+
+  size_t LGRouteMatches::size() const {
+    return matches.size();
+  }
+
+  const LGRouteMatch& LGRouteMatches::operator[](size_t i) const {
+    return matches[i];
+  }
+
+  void LGRouter::insert(Node* root, std::string_view pattern, size_t index, bool mount) {
+    Node* node = root;
+    Entry entry = Entry{index, {}};
+
+    std::string_view rest = pattern;
+    std::string_view segment;
+
+    while (!(segment = nextSegment(rest)).empty()) {
+      if (segment[0] == ':') {
+        if (!node->param) node->param.reset(new Node());
+
+        entry.paramNames.push_back(std::string(segment.substr(1)));
+        node = node->param.get();
+      } else if (segment[0] == '*') {
+        if (!node->wildcard) node->wildcard.reset(new Node());
+
+        node = node->wildcard.get();
+      } else {
+        auto child = std::lower_bound(node->children.begin(), node->children.end(), segment,
+          [](const std::pair<std::string, std::unique_ptr<Node>>& a, std::string_view b) { return a.first < b; });
+
+        if (child == node->children.end() || child->first != segment) {
+          child = node->children.insert(child, std::make_pair(std::string(segment), std::unique_ptr<Node>(new Node())));
+        }
+
+        node = child->second.get();
+      }
+    }
+
+    (mount ? node->mounts : node->routes).push_back(entry);
+  }
+
+  /**
+   * @brief Adds a route that answers to one method when the path ends at the pattern.
+   *
+   * @param pattern The route pattern (eg. "/home/:id")
+   * @param method The HTTP method the route answers to
+   * @param index The position of the middleware in the stack
+   */
+  void LGRouter::add(std::string_view pattern, LGMethod method, size_t index) {
+    if (method == LGMethod::HTTP_UNKNOWN) return;
+
+    insert(&methodRoots[(size_t)method], pattern, index, false);
+  }
+
+  /**
+   * @brief Adds a route that answers to every standard method when the path ends at the pattern.
+   *
+   * @param pattern The route pattern (eg. "/home/:id")
+   * @param index The position of the middleware in the stack
+   */
+  void LGRouter::addAny(std::string_view pattern, size_t index) {
+    insert(&anyRoot, pattern, index, false);
+  }
+
+  /**
+   * @brief Adds a pattern that matches every method and every path below it (like `app.use`).
+   *
+   * @param pattern The route pattern (eg. "/static")
+   * @param index The position of the middleware in the stack
+   */
+  void LGRouter::mount(std::string_view pattern, size_t index) {
+    insert(&mountRoot, pattern, index, true);
+  }
+
+  void LGRouter::record(const Entry& entry, LGRouteMatches& results) const {
+    results.matches.push_back(LGRouteMatch{entry.index, &entry.paramNames, results.values.size()});
+    results.values.insert(results.values.end(), results.captures.begin(), results.captures.end());
+  }
+
+  void LGRouter::matchNode(const Node* node, std::string_view rest, LGRouteMatches& results) const {
+    for (const Entry& entry : node->mounts) {
+      record(entry, results);
+    }
+
+    std::string_view segment = nextSegment(rest);
+
+    if (segment.empty()) {
+      for (const Entry& entry : node->routes) {
+        record(entry, results);
+        results.routeMatched = true;
+      }
+
+      return;
+    }
+
+    auto child = std::lower_bound(node->children.begin(), node->children.end(), segment,
+      [](const std::pair<std::string, std::unique_ptr<Node>>& a, std::string_view b) { return a.first < b; });
+
+    if (child != node->children.end() && child->first == segment) {
+      matchNode(child->second.get(), rest, results);
+    }
+
+    if (node->param) {
+      results.captures.push_back(segment);
+      matchNode(node->param.get(), rest, results);
+      results.captures.pop_back();
+    }
+
+    if (node->wildcard) {
+      matchNode(node->wildcard.get(), rest, results);
+    }
+  }
+
+  bool LGRouter::hasRoute(const Node* node, std::string_view rest) const {
+    std::string_view segment = nextSegment(rest);
+
+    if (segment.empty()) return !node->routes.empty();
+
+    auto child = std::lower_bound(node->children.begin(), node->children.end(), segment,
+      [](const std::pair<std::string, std::unique_ptr<Node>>& a, std::string_view b) { return a.first < b; });
+
+    if (child != node->children.end() && child->first == segment && hasRoute(child->second.get(), rest)) return true;
+    if (node->param && hasRoute(node->param.get(), rest)) return true;
+    if (node->wildcard && hasRoute(node->wildcard.get(), rest)) return true;
+
+    return false;
+  }
+
+  /**
+   * @brief Finds every middleware that applies to a request, in stack order.
+   * HEAD requests match GET routes when there is no HEAD route for the path. Captured params are views into `path`.
+   *
+   * @param path The request path without the query string
+   * @param method The request method
+   * @param results Cleared and filled with the matches
+   */
+  void LGRouter::match(std::string_view path, LGMethod method, LGRouteMatches& results) const {
+    results.clear();
+
+    matchNode(&mountRoot, path, results);
+
+    if (method != LGMethod::HTTP_UNKNOWN) {
+      matchNode(&anyRoot, path, results);
+
+      size_t before = results.matches.size();
+      matchNode(&methodRoots[(size_t)method], path, results);
+
+      if (method == LGMethod::HTTP_HEAD && results.matches.size() == before) {
+        matchNode(&methodRoots[(size_t)LGMethod::HTTP_GET], path, results);
+      }
+    }
+
+    std::sort(results.matches.begin(), results.matches.end(), [](const LGRouteMatch& a, const LGRouteMatch& b) {
+      return a.index < b.index;
+    });
+  }
+
+  /**
+   * @brief Finds the methods that have a route for a path. Used for 405 responses and OPTIONS.
+   *
+   * @param path The request path without the query string
+   * @return uint32_t A bit per method (1 << LGMethod), HEAD is set whenever GET is
+   */
+  uint32_t LGRouter::allowedMethods(std::string_view path) const {
+    uint32_t allowed = 0;
+
+    if (hasRoute(&anyRoot, path)) {
+      return (1u << LG_METHOD_COUNT) - 1;
+    }
+
+    for (size_t i = 0; i < LG_METHOD_COUNT; i++) {
+      if (hasRoute(&methodRoots[i], path)) allowed |= 1u << i;
+    }
+
+    if (allowed & (1u << (size_t)LGMethod::HTTP_GET)) allowed |= 1u << (size_t)LGMethod::HTTP_HEAD;
+
+    return allowed;
+  }
+
+}; // namespace LandingGear
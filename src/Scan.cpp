@@ -0,0 +1,134 @@
+#include "Scan.h"
+
+#if (defined(__x86_64__) || defined(__i386__)) && (defined(__GNUC__) || defined(__clang__))
+#define LG_SCAN_X86
+#include <immintrin.h>
+#endif
+
+namespace LandingGear {
+
+  // Scalar kernels, used on other architectures and for the tails of the vector kernels.
+
+  static const char* scanForScalar(const char* p, const char* end, char c) {
+    while (p < end && *p != c) p++;
+    return p;
+  }
+
+  static const char* skipBlanksScalar(const char* p, const char* end) {
+    while (p < end && (*p == ' ' || *p == '\t')) p++;
+    return p;
+  }
+
+#ifdef LG_SCAN_X86
+
+  // SSE2 kernels, 16 bytes per step.
+
+  __attribute__((target("sse2")))
+  static const char* scanForSSE2(const char* p, const char* end, char c) {
+    const __m128i needle = _mm_set1_epi8(c);
+
+    for (; end - p >= 16; p += 16) {
+      __m128i chunk = _mm_loadu_si128((const __m128i*)p);
+      int mask = _mm_movemask_epi8(_mm_cmpeq_epi8(chunk, needle));
+
+      if (mask != 0) return p + __builtin_ctz(mask);
+    }
+
+    return scanForScalar(p, end, c);
+  }
+
+  __attribute__((target("sse2")))
+  static const char* skipBlanksSSE2(const char* p, const char* end) {
+    const __m128i space = _mm_set1_epi8(' ');
+    const __m128i tab = _mm_set1_epi8('\t');
+
+    for (; end - p >= 16; p += 16) {
+      __m128i chunk = _mm_loadu_si128((const __m128i*)p);
+      __m128i blanks = _mm_or_si128(_mm_cmpeq_epi8(chunk, space), _mm_cmpeq_epi8(chunk, tab));
+      int mask = ~_mm_movemask_epi8(blanks) & 0xFFFF;
+
+      if (mask != 0) return p + __builtin_ctz(mask);
+    }
+
+    return skipBlanksScalar(p, end);
+  }
+
+  // AVX2 kernels, 32 bytes per step.
+
+  __attribute__((target("avx2")))
+  static const char* scanForAVX2(const char* p, const char* end, char c) {
+    const __m256i needle = _mm256_set1_epi8(c);
+
+    for (; end - p >= 32; p += 32) {
+      __m256i chunk = _mm256_loadu_si256((const __m256i*)p);
+      unsigned int mask = (unsigned int)_mm256_movemask_epi8(_mm256_cmpeq_epi8(chunk, needle));
+
+      if (mask != 0) return p + __builtin_ctz(mask);
+    }
+
+    return scanForSSE2(p, end, c);
+  }
+
+  __attribute__((target("avx2")))
+  static const char* skipBlanksAVX2(const char* p, const char* end) {
+    const __m256i space = _mm256_set1_epi8(' ');
+    const __m256i tab = _mm256_set1_epi8('\t');
+
+    for (; end - p >= 32; p += 32) {
+      __m256i chunk = _mm256_loadu_si256((const __m256i*)p);
+      __m256i blanks = _mm256_or_si256(_mm256_cmpeq_epi8(chunk, space), _mm256_cmpeq_epi8(chunk, tab));
+      unsigned int mask = ~(unsigned int)_mm256_movemask_epi8(blanks);
+
+      if (mask != 0) return p + __builtin_ctz(mask);
+    }
+
+    return skipBlanksSSE2(p, end);
+  }
+
+#endif
+
+  /**
+   * @brief The kernels picked for the running CPU.
+   *
+   */
+  struct ScanKernels {
+    const char* name;
+    const char* (*scanFor)(const char*, const char*, char);
+    const char* (*skipBlanks)(const char*, const char*);
+  };
+
+  static ScanKernels detectKernels() {
+#ifdef LG_SCAN_X86
+    __builtin_cpu_init();
+
+    if (__builtin_cpu_supports("avx2")) {
+      return ScanKernels{"avx2", scanForAVX2, skipBlanksAVX2};
+    }
+
+    if (__builtin_cpu_supports("sse2")) {
+      return ScanKernels{"sse2", scanForSSE2, skipBlanksSSE2};
+    }
+#endif
+
+    return ScanKernels{"scalar", scanForScalar, skipBlanksScalar};
+  }
+
+  // Resolved on first use so scanning works from other static initializers too.
+  static const ScanKernels& kernels() {
+    static const ScanKernels detected = detectKernels();
+    return detected;
+  }
+
+  const char* scanFor(const char* begin, const char* end, char c) {
+    return kernels().scanFor(begin, end, c);
+  }
+
+  const char* skipBlanks(const char* begin, const char* end) {
+    return kernels().skipBlanks(begin, end);
+  }
+
+  const char* scanImplementation() {
+    return kernels().name;
+  }
+
+}; // namespace LandingGear
@@ -0,0 +1,781 @@
+#include "StaticFiles.h"
+#include "HttpDate.h"
+#include "LandingGear.h"
+
+#include <cstdio>
+
+namespace LandingGear {
+
+  // Content types by lowercase file extension. Anything else is sent as application/octet-stream.
+  static const std::unordered_map<std::string, std::string> mimeTypes = {
+    {"html", "text/html; charset=utf-8"},
+    {"htm", "text/html; charset=utf-8"},
+    {"css", "text/css; charset=utf-8"},
+    {"js", "text/javascript; charset=utf-8"},
+    {"mjs", "text/javascript; charset=utf-8"},
+    {"json", "application/json"},
+    {"map", "application/json"},
+    {"txt", "text/plain; charset=utf-8"},
+    {"csv", "text/csv; charset=utf-8"},
+    {"xml", "application/xml"},
+    {"svg", "image/svg+xml"},
+    {"png", "image/png"},
+    {"jpg", "image/jpeg"},
+    {"jpeg", "image/jpeg"},
+    {"gif", "image/gif"},
+    {"webp", "image/webp"},
+    {"avif", "image/avif"},
+    {"ico", "image/x-icon"},
+    {"woff", "font/woff"},
+    {"woff2", "font/woff2"},
+    {"ttf", "font/ttf"},
+    {"otf", "font/otf"},
+    {"wasm", "application/wasm"},
+    {"pdf", "application/pdf"},
+    {"zip", "application/zip"},
+    {"mp3", "audio/mpeg"},
+    {"mp4", "video/mp4"},
+    {"webm", "video/webm"},
+  };
+
+  // File name suffixes and Content-Encoding names of the asset variants
+  static const char* encodingSuffixes[LG_ENCODING_COUNT] = {"", ".gz", ".br"};
+  static const char* encodingNames[LG_ENCODING_COUNT] = {"", "gzip", "br"};
+
+  LGAssetCache::LGAssetCache(size_t budget, size_t maxAssetSize, int revalidateInterval)
+    : used(0),
+      hits(0),
+      misses(0),
+      evictions(0),
+      budget(budget),
+      maxAssetSize(maxAssetSize),
+      revalidateInterval(revalidateInterval) {};
+
+  void LGAssetCache::erase(std::unordered_map<std::string, Entry>::iterator entry) {
+    used -= entry->second.asset->size;
+    recent.erase(entry->second.position);
+    entries.erase(entry);
+  }
+
+  /**
+   * @brief Gets the prepared asset of a file. Once the revalidate interval passed, the variants
+   * are checked against the disk, a changed, added or removed variant drops the asset.
+   *
+   * @param path The path of the original file
+   * @return std::shared_ptr<const LGCachedAsset> The asset, null on a miss
+   */
+  std::shared_ptr<const LGCachedAsset> LGAssetCache::find(const std::string& path) {
+    auto now = std::chrono::steady_clock::now();
+    std::shared_ptr<const LGCachedAsset> asset;
+
+    {
+      std::lock_guard<std::mutex> lock(mutex);
+      auto entry = entries.find(path);
+
+      if (entry == entries.end()) {
+        misses++;
+        return asset;
+      }
+
+      recent.splice(recent.begin(), recent, entry->second.position);
+      asset = entry->second.asset;
+
+      if (now - entry->second.checked < revalidateInterval) {
+        hits++;
+        return asset;
+      }
+    }
+
+    // The file system is only asked outside the lock, other workers keep hitting the cache meanwhile
+    bool unchanged = true;
+
+    for (int i = 0; i < LG_ENCODING_COUNT && unchanged; i++) {
+      LGFileInfo info;
+      bool exists = LGFile::stat(path + encodingSuffixes[i], info);
+
+      if (!asset->variants[i]) {
+        unchanged = !exists;
+      } else {
+        const LGFileInfo& source = asset->sources[i];
+        unchanged = exists && info.size == source.size && info.modified == source.modified && info.id == source.id;
+      }
+    }
+
+    std::lock_guard<std::mutex> lock(mutex);
+    auto entry = entries.find(path);
+
+    if (entry == entries.end() || entry->second.asset != asset) {
+      misses++;
+      return nullptr; // replaced or dropped meanwhile
+    }
+
+    if (!unchanged) {
+      erase(entry);
+      misses++;
+      return nullptr;
+    }
+
+    entry->second.checked = now;
+    hits++;
+
+    return asset;
+  }
+
+  /**
+   * @brief Adds or replaces the asset of a file, dropping the least recently used assets to stay within the budget.
+   *
+   * @param path The path of the original file
+   * @param asset The prepared asset
+   */
+  void LGAssetCache::insert(const std::string& path, std::shared_ptr<const LGCachedAsset> asset) {
+    if (asset->size > budget) return;
+
+    std::lock_guard<std::mutex> lock(mutex);
+    auto entry = entries.find(path);
+
+    if (entry != entries.end()) {
+      erase(entry);
+    }
+
+    recent.push_front(path);
+    entries[path] = Entry{asset, std::chrono::steady_clock::now(), recent.begin()};
+    used += asset->size;
+
+    while (used > budget) {
+      erase(entries.find(recent.back()));
+      evictions++;
+    }
+  }
+
+  LGAssetCacheStats LGAssetCache::stats() {
+    std::lock_guard<std::mutex> lock(mutex);
+
+    return LGAssetCacheStats{hits.load(), misses.load(), evictions.load(), entries.size(), used};
+  }
+
+  // Mapped files at least this large are read ahead as they are sent rather than all at once
+  static const uint64_t SEQUENTIAL_MAP_SIZE = 1024 * 1024;
+
+  LGFileCache::LGFileCache(size_t capacity, int revalidateInterval, bool memoryMap)
+    : capacity(capacity),
+      revalidateInterval(revalidateInterval),
+      memoryMap(memoryMap) {};
+
+  /**
+   * @brief Gets an open file, opening it if it isn't cached or changed on disk.
+   *
+   * @param path The path of the file
+   * @return std::shared_ptr<LGFile> The file, null if it doesn't exist or isn't a regular file
+   */
+  std::shared_ptr<LGFile> LGFileCache::open(const std::string& path) {
+    auto now = std::chrono::steady_clock::now();
+    std::shared_ptr<LGFile> cached;
+
+    {
+      std::lock_guard<std::mutex> lock(mutex);
+      auto entry = entries.find(path);
+
+      if (entry != entries.end()) {
+        recent.splice(recent.begin(), recent, entry->second.position);
+
+        if (now - entry->second.checked < revalidateInterval) {
+          return entry->second.file;
+        }
+
+        cached = entry->second.file;
+      }
+    }
+
+    // The file system is only asked outside the lock, other workers keep hitting the cache meanwhile
+    if (cached) {
+      LGFileInfo info;
+
+      if (LGFile::stat(path, info) && info.size == cached->info.size && info.modified == cached->info.modified && info.id == cached->info.id) {
+        std::lock_guard<std::mutex> lock(mutex);
+        auto entry = entries.find(path);
+
+        if (entry != entries.end() && entry->second.file == cached) {
+          entry->second.checked = now;
+        }
+
+        return cached;
+      }
+    }
+
+    std::shared_ptr<LGFile> file = std::shared_ptr<LGFile>(LGFile::open(path));
+
+    if (file && memoryMap) {
+      file->map(file->info.size >= SEQUENTIAL_MAP_SIZE); // before any other worker can see it
+    }
+
+    std::lock_guard<std::mutex> lock(mutex);
+    auto entry = entries.find(path);
+
+    if (!file) {
+      if (entry != entries.end()) {
+        recent.erase(entry->second.position);
+        entries.erase(entry);
+      }
+
+      return file;
+    }
+
+    if (entry != entries.end()) {
+      entry->second.file = file;
+      entry->second.checked = now;
+      return file;
+    }
+
+    if (capacity == 0) {
+      return file;
+    }
+
+    recent.push_front(path);
+    entries[path] = Entry{file, now, recent.begin()};
+
+    while (entries.size() > capacity) {
+      entries.erase(recent.back());
+      recent.pop_back();
+    }
+
+    return file;
+  }
+
+  /**
+   * @brief Picks a content type from the file extension.
+   *
+   * @param path The path of the file
+   * @return std::string The content type
+   */
+  static std::string mimeType(const std::string& path) {
+    size_t dot = path.rfind('.');
+    size_t slash = path.rfind('/');
+
+    if (dot == std::string::npos || (slash != std::string::npos && dot < slash)) {
+      return "application/octet-stream";
+    }
+
+    std::string extension = path.substr(dot + 1);
+    std::transform(extension.begin(), extension.end(), extension.begin(),
+      [](unsigned char c){ return std::tolower(c); });
+
+    auto type = mimeTypes.find(extension);
+
+    return type != mimeTypes.end() ? type->second : "application/octet-stream";
+  }
+
+  /**
+   * @brief Whether a relative path has a ".." segment, which could leave the served folder.
+   *
+   */
+  static bool escapesFolder(std::string_view path) {
+    size_t start = 0;
+
+    while (start <= path.size()) {
+      size_t end = path.find_first_of("/\\", start);
+      if (end == std::string_view::npos) end = path.size();
+
+      if (path.substr(start, end - start) == "..") return true;
+
+      start = end + 1;
+    }
+
+    return false;
+  }
+
+  /**
+   * @brief Whether an Accept-Encoding header allows an encoding. An encoding with q=0 is refused,
+   * "*" only applies when the encoding isn't listed itself (eg. "*, gzip;q=0" refuses gzip).
+   *
+   * @param header The header value (eg. "gzip, deflate, br;q=0.9")
+   * @param encoding The encoding (eg. "gzip")
+   */
+  bool acceptsEncoding(std::string_view header, std::string_view encoding) {
+    int wildcard = -1; // what "*" allows, -1 when it isn't listed
+
+    while (!header.empty()) {
+      size_t end = header.find(',');
+      std::string_view item = header.substr(0, end);
+      header = end == std::string_view::npos ? std::string_view() : header.substr(end + 1);
+
+      size_t parameters = item.find(';');
+      std::string_view name = item.substr(0, parameters);
+
+      while (!name.empty() && name.front() == ' ') name.remove_prefix(1);
+      while (!name.empty() && name.back() == ' ') name.remove_suffix(1);
+
+      bool explicitly = equalsIgnoreCase(name, encoding);
+      if (!explicitly && name != "*") continue;
+
+      bool allowed = true;
+
+      if (parameters != std::string_view::npos) {
+        std::string_view quality = item.substr(parameters + 1);
+        size_t q = quality.find_first_of("qQ");
+
+        if (q != std::string_view::npos && quality.substr(q + 1, 1) == "=") {
+          quality.remove_prefix(q + 2);
+          allowed = quality.find_first_not_of("0. ") != std::string_view::npos; // anything but q=0, q=0.0, ...
+        }
+      }
+
+      if (explicitly) return allowed;
+
+      wildcard = allowed;
+    }
+
+    return wildcard == 1;
+  }
+
+  /**
+   * @brief Builds the entity tag of a file from its modification time and size, which change whenever
+   * its content does without reading it. Variants get a suffix so no two representations share a tag.
+   *
+   * @return std::string The quoted tag (eg. "\"17a2c3b4d5e6f708-1f40-gzip\"")
+   */
+  static std::string entityTag(const LGFileInfo& info, int encoding) {
+    char tag[64];
+
+    snprintf(tag, sizeof(tag), "\"%llx-%llx%s%s\"", (unsigned long long)info.modified, (unsigned long long)info.size,
+      encoding != LG_ENCODING_IDENTITY ? "-" : "", encodingNames[encoding]);
+
+    return tag;
+  }
+
+  // Seconds since the epoch of a file's modification time, the precision of Last-Modified
+  static int64_t modifiedSeconds(const LGFileInfo& info) {
+    return info.modified >= 0 ? info.modified / 1000000000 : (info.modified + 1) / 1000000000 - 1;
+  }
+
+  /**
+   * @brief Whether an If-None-Match header lists an entity tag. Uses the weak comparison, so W/ prefixes are ignored.
+   *
+   * @param header The header value (eg. "\"a-1\", W/\"b-2\"" or "*")
+   * @param etag The quoted tag of the file
+   */
+  static bool matchesEntityTag(std::string_view header, std::string_view etag) {
+    while (!header.empty()) {
+      size_t end = header.find(',');
+      std::string_view item = header.substr(0, end);
+      header = end == std::string_view::npos ? std::string_view() : header.substr(end + 1);
+
+      while (!item.empty() && (item.front() == ' ' || item.front() == '\t')) item.remove_prefix(1);
+      while (!item.empty() && (item.back() == ' ' || item.back() == '\t')) item.remove_suffix(1);
+
+      if (item == "*") return true;
+      if (item.substr(0, 2) == "W/") item.remove_prefix(2);
+
+      if (item == etag) return true;
+    }
+
+    return false;
+  }
+
+  /**
+   * @brief Whether the client's copy is still current, so a 304 can be sent instead of the file.
+   * If-None-Match wins over If-Modified-Since, as the entity tag is the finer validator.
+   *
+   * @param req The request
+   * @param options The mount's settings, disabled validators are never compared
+   * @param etag The quoted tag of the file
+   * @param info The file
+   */
+  static bool notModified(LGRequest& req, const LGStaticOptions& options, const std::string& etag, const LGFileInfo& info) {
+    if (req.headers.hasHeader(LGHeaderId::IF_NONE_MATCH)) {
+      return options.etag && matchesEntityTag(req.headers.getHeader(LGHeaderId::IF_NONE_MATCH), etag);
+    }
+
+    int64_t since;
+
+    if (options.lastModified && req.headers.hasHeader(LGHeaderId::IF_MODIFIED_SINCE)
+      && parseHttpDate(req.headers.getHeader(LGHeaderId::IF_MODIFIED_SINCE), since)) {
+      return modifiedSeconds(info) <= since;
+    }
+
+    return false;
+  }
+
+  enum class RangeResult {
+    NONE, // no usable Range header, the whole file is sent
+    SATISFIABLE,
+    UNSATISFIABLE, // every range starts past the end of the file
+  };
+
+  static bool parseOffset(std::string_view text, uint64_t& value) {
+    if (text.empty() || text.size() > 19) return false; // 19 digits always fit
+
+    value = 0;
+
+    for (char c : text) {
+      if (c < '0' || c > '9') return false;
+      value = value * 10 + (c - '0');
+    }
+
+    return true;
+  }
+
+  /**
+   * @brief Parses a Range header into ranges of a file, clamped to its size. Malformed headers,
+   * units other than bytes and more than `maxRanges` ranges are ignored, as if there was no header.
+   *
+   * @param header The header value (eg. "bytes=0-99, 500-, -200")
+   * @param size The size of the file
+   * @param maxRanges The most ranges to serve
+   * @param ranges Filled with the satisfiable ranges, in the order they were asked for
+   */
+  static RangeResult parseRanges(std::string_view header, uint64_t size, size_t maxRanges, std::vector<LGByteRange>& ranges) {
+    while (!header.empty() && header.front() == ' ') header.remove_prefix(1);
+
+    if (header.substr(0, 6) != "bytes=") return RangeResult::NONE;
+    header.remove_prefix(6);
+
+    while (!header.empty()) {
+      size_t end = header.find(',');
+      std::string_view item = header.substr(0, end);
+      header = end == std::string_view::npos ? std::string_view() : header.substr(end + 1);
+
+      while (!item.empty() && (item.front() == ' ' || item.front() == '\t')) item.remove_prefix(1);
+      while (!item.empty() && (item.back() == ' ' || item.back() == '\t')) item.remove_suffix(1);
+
+      if (item.empty()) continue;
+
+      size_t dash = item.find('-');
+      if (dash == std::string_view::npos) return RangeResult::NONE;
+
+      std::string_view first = item.substr(0, dash);
+      std::string_view last = item.substr(dash + 1);
+      uint64_t start, stop;
+
+      if (first.empty()) {
+        // "-500" is the last 500 bytes
+        uint64_t suffix;
+        if (!parseOffset(last, suffix)) return RangeResult::NONE;
+        if (suffix == 0 || size == 0) continue;
+
+        start = size - std::min(suffix, size);
+        stop = size - 1;
+      } else {
+        if (!parseOffset(first, start)) return RangeResult::NONE;
+
+        if (last.empty()) {
+          stop = size - 1;
+        } else if (!parseOffset(last, stop) || stop < start) {
+          return RangeResult::NONE;
+        }
+
+        if (start >= size) continue;
+        stop = std::min(stop, size - 1);
+      }
+
+      if (ranges.size() == maxRanges) return RangeResult::NONE;
+
+      ranges.push_back(LGByteRange{start, stop - start + 1});
+    }
+
+    return ranges.empty() ? RangeResult::UNSATISFIABLE : RangeResult::SATISFIABLE;
+  }
+
+  /**
+   * @brief Whether the Range header should be honored. With an If-Range that no longer matches
+   * the file, the client's partial copy is stale and gets the whole file instead.
+   * Entity tags use the strong comparison, so weak tags never match.
+   *
+   */
+  static bool rangeApplies(LGRequest& req, const std::string& etag, const LGFileInfo& info) {
+    if (!req.headers.hasHeader(LGHeaderId::IF_RANGE)) return true;
+
+    std::string_view condition = req.headers.getHeader(LGHeaderId::IF_RANGE);
+
+    if (!condition.empty() && condition.front() == '"') return condition == etag;
+
+    int64_t date;
+
+    return parseHttpDate(condition, date) && date == modifiedSeconds(info);
+  }
+
+  /**
+   * @brief Sets the caching headers of a file on a response, for files sent from disk and 304s.
+   *
+   */
+  static void setCacheHeaders(LGResponse& res, const LGStaticOptions& options, const std::string& etag, const LGFileInfo& info) {
+    if (!options.cacheControl.empty()) {
+      res.header("Cache-Control", options.cacheControl);
+    }
+
+    if (options.etag) {
+      res.header("ETag", etag);
+    }
+
+    if (options.lastModified) {
+      res.header("Last-Modified", formatHttpDate(modifiedSeconds(info)));
+    }
+  }
+
+  /**
+   * @brief Reads a file into memory as a prepared response. The file is read straight after the headers.
+   *
+   * @param file The open file
+   * @param headers The headers up to the Content-Length, which is added
+   * @return std::shared_ptr<const std::string> The prepared response, null if the file couldn't be read
+   */
+  static std::shared_ptr<const std::string> prepareAsset(const LGFile& file, const std::string& headers) {
+    std::shared_ptr<std::string> prepared = std::make_shared<std::string>(headers);
+
+    *prepared += "Content-Length: ";
+    *prepared += std::to_string(file.info.size);
+    *prepared += "\r\n\r\n";
+
+    size_t start = prepared->size();
+    prepared->resize(start + file.info.size);
+
+    for (size_t read = 0; read < file.info.size;) {
+      int bytes = file.readAt(&(*prepared)[start + read], file.info.size - read, read);
+      if (bytes <= 0) return nullptr; // the file shrank or failed while reading
+
+      read += bytes;
+    }
+
+    return prepared;
+  }
+
+  /**
+   * @brief Loads a small file and its precompressed siblings as an asset.
+   *
+   * @param file The original file, already open
+   * @param path The path of the original file
+   * @param options The mount's settings, for the caching headers
+   * @return std::shared_ptr<const LGCachedAsset> The asset, null if a file couldn't be read
+   */
+  static std::shared_ptr<const LGCachedAsset> loadAsset(const LGFile& file, const std::string& path, const LGStaticOptions& options) {
+    std::shared_ptr<LGCachedAsset> asset = std::make_shared<LGCachedAsset>();
+    std::unique_ptr<LGFile> siblings[LG_ENCODING_COUNT];
+
+    for (int i = LG_ENCODING_GZIP; i < LG_ENCODING_COUNT; i++) {
+      siblings[i].reset(LGFile::open(path + encodingSuffixes[i]));
+    }
+
+    bool hasVariants = siblings[LG_ENCODING_GZIP] || siblings[LG_ENCODING_BROTLI];
+
+    std::string headers = "Content-Type: ";
+    headers += mimeType(path);
+    headers += "\r\n";
+
+    if (hasVariants) {
+      headers += "Vary: Accept-Encoding\r\n";
+    }
+
+    if (!options.cacheControl.empty()) {
+      headers += "Cache-Control: ";
+      headers += options.cacheControl;
+      headers += "\r\n";
+    }
+
+    asset->size = 0;
+
+    for (int i = 0; i < LG_ENCODING_COUNT; i++) {
+      const LGFile* source = i == LG_ENCODING_IDENTITY ? &file : siblings[i].get();
+      if (source == nullptr) continue;
+
+      std::string variantHeaders = headers;
+      asset->etags[i] = entityTag(source->info, i);
+
+      if (options.etag) {
+        variantHeaders += "ETag: ";
+        variantHeaders += asset->etags[i];
+        variantHeaders += "\r\n";
+      }
+
+      if (options.lastModified) {
+        variantHeaders += "Last-Modified: ";
+        variantHeaders += formatHttpDate(modifiedSeconds(source->info));
+        variantHeaders += "\r\n";
+      }
+
+      if (i == LG_ENCODING_IDENTITY && options.maxRanges > 0) {
+        variantHeaders += "Accept-Ranges: bytes\r\n"; // ranges are served from the original file
+      }
+
+      if (i != LG_ENCODING_IDENTITY) {
+        variantHeaders += "Content-Encoding: ";
+        variantHeaders += encodingNames[i];
+        variantHeaders += "\r\n";
+      }
+
+      asset->variants[i] = prepareAsset(*source, variantHeaders);
+      if (!asset->variants[i]) return nullptr;
+
+      asset->sources[i] = source->info;
+      asset->size += asset->variants[i]->size();
+    }
+
+    return asset;
+  }
+
+  /**
+   * @brief Picks the variant to send, preferring brotli, then gzip, then the original.
+   *
+   * @return int The `LGAssetEncoding` of the variant
+   */
+  static int pickVariant(const LGCachedAsset& asset, LGRequest& req) {
+    if (asset.variants[LG_ENCODING_GZIP] || asset.variants[LG_ENCODING_BROTLI]) {
+      std::string_view accepted = req.headers.getHeader(LGHeaderId::ACCEPT_ENCODING);
+
+      for (int i = LG_ENCODING_BROTLI; i > LG_ENCODING_IDENTITY; i--) {
+        if (asset.variants[i] && acceptsEncoding(accepted, encodingNames[i])) {
+          return i;
+        }
+      }
+    }
+
+    return LG_ENCODING_IDENTITY;
+  }
+
+  /**
+   * @brief Sends the picked variant of an asset, or a 304 if the client has it already.
+   *
+   */
+  static void sendAsset(const LGCachedAsset& asset, const LGStaticOptions& options, LGRequest& req, LGResponse& res) {
+    int variant = pickVariant(asset, req);
+    const std::string& etag = asset.etags[variant];
+
+    if (notModified(req, options, etag, asset.sources[variant])) {
+      setCacheHeaders(res, options, etag, asset.sources[variant]);
+
+      if (asset.variants[LG_ENCODING_GZIP] || asset.variants[LG_ENCODING_BROTLI]) {
+        res.header("Vary", "Accept-Encoding");
+      }
+
+      res.status(304).end("");
+      return;
+    }
+
+    res.sendPrepared(asset.variants[variant]);
+  }
+
+  LGMiddlewareCB getStatic(std::string folderpath) {
+    return getStatic(folderpath, LGStaticOptions());
+  }
+
+  /**
+   * @brief Serves the files of a folder. The part of the request path after the folder name
+   * (or the whole path if it doesn't contain it) is looked up in the folder. Requests for
+   * anything that isn't a file are passed on with next().
+   *
+   * Small files are kept in memory as prepared responses, with ".gz" and ".br" siblings sent
+   * to clients that accept them. Responses that already had headers set are always built from the file.
+   * Every file carries ETag, Last-Modified and Cache-Control headers, conditional requests
+   * for a file the client already has are answered with 304. Range requests are answered
+   * with 206 (multipart/byteranges for several ranges) or 416, sent straight from the file.
+   *
+   * @param folderpath The folder to serve (eg. "public")
+   * @param options Settings for the caches and caching headers
+   * @return LGMiddlewareCB The middleware, use it with `app.use`
+   */
+  LGMiddlewareCB getStatic(std::string folderpath, LGStaticOptions options) {
+    std::string folder = folderpath;
+
+    while (!folder.empty() && folder.front() == '/') folder.erase(0, 1);
+    while (!folder.empty() && folder.back() == '/') folder.pop_back();
+
+    std::shared_ptr<LGFileCache> cache = std::make_shared<LGFileCache>(options.maxOpenFiles, options.revalidateInterval, options.memoryMap);
+    std::shared_ptr<LGAssetCache> assets = options.assetCache;
+
+    if (!assets && options.memoryBudget > 0) {
+      assets = std::make_shared<LGAssetCache>(options.memoryBudget, options.maxCachedFileSize, options.revalidateInterval);
+    }
+
+    return [folder, cache, assets, options](LGRequest& req, LGResponse& res, NextFunction next) {
+      if (req.methodId != LGMethod::HTTP_GET && req.methodId != LGMethod::HTTP_HEAD) {
+        next();
+        return;
+      }
+
+      std::string_view requestPath = std::string_view(req.path);
+      requestPath = requestPath.substr(0, requestPath.find('?'));
+
+      size_t found = folder.empty() ? std::string_view::npos : requestPath.find(folder);
+      if (found != std::string_view::npos) {
+        requestPath.remove_prefix(found + folder.size());
+      }
+
+      while (!requestPath.empty() && requestPath.front() == '/') {
+        requestPath.remove_prefix(1);
+      }
+
+      if (requestPath.empty() || escapesFolder(requestPath)) {
+        next();
+        return;
+      }
+
+      std::string filePath = folder.empty() ? "." : folder;
+      filePath += '/';
+      filePath += requestPath;
+
+      // HEAD responses, range requests and responses with headers set by earlier middleware are built from the file
+      bool cacheable = assets && req.methodId == LGMethod::HTTP_GET && res.headers.empty()
+        && !req.headers.hasHeader(LGHeaderId::RANGE);
+
+      if (cacheable) {
+        std::shared_ptr<const LGCachedAsset> asset = assets->find(filePath);
+
+        if (asset) {
+          sendAsset(*asset, options, req, res);
+          return;
+        }
+      }
+
+      std::shared_ptr<LGFile> file = cache->open(filePath);
+
+      if (!file) {
+        next();
+        return;
+      }
+
+      if (cacheable && file->info.size <= assets->maxAssetSize) {
+        std::shared_ptr<const LGCachedAsset> asset = loadAsset(*file, filePath, options);
+
+        if (asset) {
+          assets->insert(filePath, asset);
+          sendAsset(*asset, options, req, res);
+          return;
+        }
+      }
+
+      std::string etag = entityTag(file->info, LG_ENCODING_IDENTITY);
+      setCacheHeaders(res, options, etag, file->info);
+
+      if (notModified(req, options, etag, file->info)) {
+        res.status(304).end("");
+        return;
+      }
+
+      if (options.maxRanges > 0) {
+        res.header("Accept-Ranges", "bytes");
+      }
+
+      if (!res.headers.hasHeader(LGHeaderId::CONTENT_TYPE)) {
+        res.header("Content-Type", mimeType(filePath));
+      }
+
+      if (options.maxRanges > 0 && req.methodId == LGMethod::HTTP_GET && req.headers.hasHeader(LGHeaderId::RANGE)
+        && rangeApplies(req, etag, file->info)) {
+        std::vector<LGByteRange> ranges;
+        RangeResult result = parseRanges(req.headers.getHeader(LGHeaderId::RANGE), file->info.size, options.maxRanges, ranges);
+
+        if (result == RangeResult::UNSATISFIABLE) {
+          res.header("Content-Range", "bytes */" + std::to_string(file->info.size));
+          res.send(416, "");
+          return;
+        }
+
+        if (result == RangeResult::SATISFIABLE) {
+          res.sendFileRanges(file, ranges);
+          return;
+        }
+      }
+
+      res.sendFile(file);
+    };
+  }
+
+}; // namespace LandingGear
@@ -0,0 +1,132 @@
+#include "LandingGear.h"
+
+#ifdef LG_HAS_COROUTINES
+
+namespace LandingGear {
+
+  LGTask::LGTask(): handle(nullptr) {};
+  LGTask::LGTask(Handle handle): handle(handle) {};
+  LGTask::LGTask(LGTask&& other) noexcept: handle(std::exchange(other.handle, nullptr)) {};
+
+  LGTask::~LGTask() {
+    if (handle) {
+      handle.destroy();
+    }
+  }
+
+  LGTask& LGTask::operator=(LGTask&& other) noexcept {
+    if (this != &other) {
+      if (handle) {
+        handle.destroy();
+      }
+
+      handle = std::exchange(other.handle, nullptr);
+    }
+
+    return *this;
+  }
+
+  bool LGTask::done() const {
+    return !handle || handle.done();
+  }
+
+  void LGTask::result() const {
+    if (handle && handle.promise().error) {
+      std::rethrow_exception(handle.promise().error);
+    }
+  }
+
+  bool LGTask::await_ready() const {
+    return done();
+  }
+
+  void LGTask::await_suspend(std::coroutine_handle<> awaiting) {
+    handle.promise().continuation = awaiting;
+  }
+
+  void LGTask::await_resume() const {
+    result();
+  }
+
+  /**
+   * @brief Runs when a task returns. Continues the task awaiting it, or lets the request's middleware stack move on.
+   *
+   * @param handle The task
+   * @return std::coroutine_handle<> What runs next
+   */
+  std::coroutine_handle<> LGTask::FinalAwaiter::await_suspend(Handle handle) noexcept {
+    promise_type& promise = handle.promise();
+
+    if (promise.continuation) {
+      return promise.continuation;
+    }
+
+    if (promise.request) {
+      if (promise.error) {
+        std::rethrow_exception(promise.error); // ends the process, like an exception escaping a plain handler
+      }
+
+      promise.request->taskFinished(promise.position);
+    }
+
+    return std::noop_coroutine();
+  }
+
+  LGNext::LGNext(LGRequest* request, size_t position): request(request), position(position) {};
+
+  /**
+   * @brief Moves on to the next middleware. Await the result to continue once the rest of the stack is done.
+   *
+   * @return Awaiter Suspends until the rest of the stack is done
+   */
+  LGNext::Awaiter LGNext::operator()() const {
+    request->advanceFrom(position);
+
+    return Awaiter{request, position};
+  }
+
+  void LGNext::Awaiter::await_suspend(std::coroutine_handle<> awaiting) {
+    request->continuations.push_back(LGRequest::LGContinuation{awaiting, position});
+  }
+
+  void LGWriteResult::await_suspend(std::coroutine_handle<> awaiting) {
+    response->drainWaiter = awaiting;
+  }
+
+  /**
+   * @brief Turns a coroutine into middleware. It runs on the connection's thread up to its first `co_await`
+   * that has to wait, the connection goes on with other work meanwhile and the middleware stack continues
+   * once it calls `next` or returns. Only the awaitables of the library (`receiveBody`, `write`, `next`
+   * and other tasks) may suspend it, they are resumed from the connection's thread.
+   *
+   * @param cb The coroutine, eg. (req, res, next) -> LGTask {}
+   * @return LGMiddlewareCB The middleware
+   */
+  LGMiddlewareCB coroutine(LGAsyncMiddlewareCB cb) {
+    return [cb](LGRequest& req, LGResponse& res, NextFunction) {
+      size_t position = req.chainPosition;
+
+      req.adoptTask(cb(req, res, LGNext(&req, position)), position);
+    };
+  }
+
+  /**
+   * @brief Turns a coroutine into a route handler. Like plain handlers, the next middleware runs
+   * if the coroutine returns without responding.
+   *
+   * @param cb The coroutine, eg. (req, res) -> LGTask {}
+   * @return LGMiddlewareCB The middleware
+   */
+  LGMiddlewareCB coroutine(LGAsyncReqCallback cb) {
+    return coroutine([cb](LGRequest& req, LGResponse& res, LGNext next) -> LGTask {
+      co_await cb(req, res);
+
+      if (!res.headersSent) {
+        next();
+      }
+    });
+  }
+
+}; // namespace LandingGear
+
+#endif
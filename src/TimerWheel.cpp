@@ -0,0 +1,144 @@
+#include "TimerWheel.h"
+
+#include <algorithm>
+
+namespace LandingGear {
+
+  // Ticks the wheel can hold a timer for, later expiries are moved in to the last one
+  static const uint64_t TIMER_SPAN = ((uint64_t)1 << (LG_TIMER_SLOT_BITS * LG_TIMER_LEVELS)) - 1;
+
+  static void unlink(LGTimerLink* link) {
+    link->prev->next = link->next;
+    link->next->prev = link->prev;
+    link->prev = nullptr;
+    link->next = nullptr;
+  }
+
+  static void pushBack(LGTimerLink* head, LGTimerLink* link) {
+    link->prev = head->prev;
+    link->next = head;
+    head->prev->next = link;
+    head->prev = link;
+  }
+
+  // Moves every link of `from` to the empty list `to`
+  static void take(LGTimerLink* from, LGTimerLink* to) {
+    if (from->next == from) {
+      to->next = to;
+      to->prev = to;
+      return;
+    }
+
+    to->next = from->next;
+    to->prev = from->prev;
+    to->next->prev = to;
+    to->prev->next = to;
+
+    from->next = from;
+    from->prev = from;
+  }
+
+  LGTimer::~LGTimer() {
+    cancel();
+  }
+
+  bool LGTimer::scheduled() const {
+    return next != nullptr;
+  }
+
+  void LGTimer::cancel() {
+    if (next != nullptr) {
+      unlink(this);
+    }
+  }
+
+  LGTimerWheel::LGTimerWheel(): current(0), start(std::chrono::steady_clock::now()) {
+    for (size_t level = 0; level < LG_TIMER_LEVELS; level++) {
+      for (size_t index = 0; index < LG_TIMER_SLOTS; index++) {
+        slots[level][index].next = &slots[level][index];
+        slots[level][index].prev = &slots[level][index];
+      }
+    }
+  }
+
+  /**
+   * @brief Schedules a timer, replacing its previous schedule.
+   *
+   * @param timer The timer
+   * @param milliseconds Time until it expires, rounded up to whole ticks
+   */
+  void LGTimerWheel::schedule(LGTimer& timer, int milliseconds) {
+    timer.cancel();
+
+    uint64_t elapsed = (std::chrono::steady_clock::now() - start) / std::chrono::milliseconds(LG_TIMER_TICK_MS);
+    uint64_t ticks = (std::max(milliseconds, 0) + LG_TIMER_TICK_MS - 1) / LG_TIMER_TICK_MS;
+
+    // Never the tick being handled, its slot won't come around again for a whole turn
+    timer.expires = std::max(current + 1, elapsed + ticks);
+    place(&timer);
+  }
+
+  /**
+   * @brief Expires every timer due by `now`, in order of ticks.
+   *
+   * @param now The current time
+   */
+  void LGTimerWheel::advance(std::chrono::steady_clock::time_point now) {
+    uint64_t target = (now - start) / std::chrono::milliseconds(LG_TIMER_TICK_MS);
+
+    while (current < target) {
+      current++;
+
+      // Whenever a level went around, the next slot of the level above is spread over the levels below
+      size_t index = current & (LG_TIMER_SLOTS - 1);
+
+      for (size_t level = 1; level < LG_TIMER_LEVELS && index == 0; level++) {
+        index = (current >> (level * LG_TIMER_SLOT_BITS)) & (LG_TIMER_SLOTS - 1);
+        cascade(level, index);
+      }
+
+      expire(current & (LG_TIMER_SLOTS - 1));
+    }
+  }
+
+  // Puts a timer into the slot of the lowest level whose span covers its expiry
+  void LGTimerWheel::place(LGTimer* timer) {
+    if (timer->expires - current > TIMER_SPAN) {
+      timer->expires = current + TIMER_SPAN;
+    }
+
+    uint64_t delta = timer->expires - current;
+    size_t level = 0;
+
+    while (level + 1 < LG_TIMER_LEVELS && delta >= ((uint64_t)1 << ((level + 1) * LG_TIMER_SLOT_BITS))) {
+      level++;
+    }
+
+    size_t index = (timer->expires >> (level * LG_TIMER_SLOT_BITS)) & (LG_TIMER_SLOTS - 1);
+    pushBack(&slots[level][index], timer);
+  }
+
+  void LGTimerWheel::cascade(size_t level, size_t index) {
+    LGTimerLink pending;
+    take(&slots[level][index], &pending);
+
+    while (pending.next != &pending) {
+      LGTimer* timer = static_cast<LGTimer*>(pending.next);
+      unlink(timer);
+      place(timer);
+    }
+  }
+
+  void LGTimerWheel::expire(size_t index) {
+    LGTimerLink due;
+    take(&slots[0][index], &due);
+
+    // Taken one at a time, a callback may cancel or delete any of the others
+    while (due.next != &due) {
+      LGTimer* timer = static_cast<LGTimer*>(due.next);
+      unlink(timer);
+      timer->onExpire();
+    }
+  }
+
+}; // namespace LandingGear
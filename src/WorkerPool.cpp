@@ -0,0 +1,174 @@
+#include "WorkerPool.h"
+
+namespace LandingGear {
+
+  // The pool and queue index of the worker running on the current thread (if any).
+  static thread_local LGWorkerPool* currentPool = nullptr;
+  static thread_local size_t currentIndex = 0;
+
+  LGWorkerPool::LGWorkerPool(): pending(0), nextQueue(0), running(false) {};
+
+  LGWorkerPool::~LGWorkerPool() {
+    stop();
+  }
+
+  /**
+   * @brief Starts the worker threads. Does nothing if the pool is already running.
+   *
+   * @param count The amount of workers to start. 0 uses the hardware concurrency.
+   */
+  void LGWorkerPool::start(size_t count) {
+    if (running) return;
+
+    if (count == 0) {
+      count = std::max(1u, std::thread::hardware_concurrency());
+    }
+
+    running = true;
+
+    for (size_t i = 0; i < count; i++) {
+      queues.push_back(std::unique_ptr<WorkerQueue>(new WorkerQueue()));
+    }
+
+    for (size_t i = 0; i < count; i++) {
+      threads.push_back(std::thread(&LGWorkerPool::work, this, i));
+    }
+  }
+
+  /**
+   * @brief Stops all workers and waits for them to exit. Jobs that have not started are dropped.
+   *
+   */
+  void LGWorkerPool::stop() {
+    {
+      std::lock_guard<std::mutex> guard(sleepLock);
+      if (!running) return;
+      running = false;
+    }
+
+    wakeup.notify_all();
+
+    for (std::thread& thread : threads) {
+      if (thread.joinable()) thread.join();
+    }
+
+    threads.clear();
+    queues.clear();
+    pending = 0;
+  }
+
+  /**
+   * @brief Queues a job. Jobs submitted from a worker stay on that worker's queue,
+   * everything else is spread round robin.
+   *
+   * @param job The job to run
+   */
+  void LGWorkerPool::submit(LGJob job) {
+    size_t index = currentPool == this
+      ? currentIndex
+      : nextQueue.fetch_add(1, std::memory_order_relaxed) % queues.size();
+
+    // Counted before it can be taken, a worker that takes it right away must not decrement below zero
+    {
+      std::lock_guard<std::mutex> guard(sleepLock);
+      pending++;
+    }
+
+    {
+      std::lock_guard<std::mutex> guard(queues[index]->lock);
+      queues[index]->jobs.push_back(std::move(job));
+    }
+
+    wakeup.notify_one();
+  }
+
+  /**
+   * @brief The amount of worker threads.
+   *
+   * @return size_t The worker count
+   */
+  size_t LGWorkerPool::size() const {
+    return threads.size();
+  }
+
+  /**
+   * @brief The amount of jobs waiting for a worker, including ones still being submitted.
+   *
+   * @return size_t The job count
+   */
+  size_t LGWorkerPool::queued() const {
+    return pending;
+  }
+
+  /**
+   * @brief Takes the newest job from a worker's own queue.
+   *
+   * @param index The worker's queue index
+   * @param job Where to store the job
+   * @return true - A job was found
+   * @return false - The queue is empty
+   */
+  bool LGWorkerPool::pop(size_t index, LGJob& job) {
+    WorkerQueue& queue = *queues[index];
+    std::lock_guard<std::mutex> guard(queue.lock);
+
+    if (queue.jobs.empty()) return false;
+
+    job = std::move(queue.jobs.back());
+    queue.jobs.pop_back();
+
+    return true;
+  }
+
+  /**
+   * @brief Takes the oldest job from any other worker's queue.
+   *
+   * @param index The stealing worker's queue index
+   * @param job Where to store the job
+   * @return true - A job was stolen
+   * @return false - Every other queue is empty
+   */
+  bool LGWorkerPool::steal(size_t index, LGJob& job) {
+    for (size_t i = 1; i < queues.size(); i++) {
+      WorkerQueue& queue = *queues[(index + i) % queues.size()];
+      std::unique_lock<std::mutex> guard(queue.lock, std::try_to_lock);
+
+      if (!guard.owns_lock() || queue.jobs.empty()) continue;
+
+      job = std::move(queue.jobs.front());
+      queue.jobs.pop_front();
+
+      return true;
+    }
+
+    return false;
+  }
+
+  /**
+   * @brief The main loop of a worker thread.
+   *
+   * @param index The worker's queue index
+   */
+  void LGWorkerPool::work(size_t index) {
+    currentPool = this;
+    currentIndex = index;
+
+    while (true) {
+      LGJob job;
+
+      if (pop(index, job) || steal(index, job)) {
+        pending--;
+        job();
+        continue;
+      }
+
+      std::unique_lock<std::mutex> guard(sleepLock);
+      wakeup.wait(guard, [&]() { return pending > 0 || !running; });
+
+      if (!running) break;
+    }
+
+    currentPool = nullptr;
+  }
+
+}; // namespace LandingGear
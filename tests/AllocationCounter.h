@@ -0,0 +1,58 @@
+/**
+ * @file AllocationCounter.h
+ * @author Mason Marquez (theboys619@gmail.com)
+ * @brief Replaces the global operator new to count heap allocations. Include it in exactly one file of a program.
+ * @version 0.1
+ * @date 2022-11-11
+ *
+ * @copyright Copyright (c) 2022
+ *
+ */
+
+#ifndef ALLOCATIONCOUNTER_H
+#define ALLOCATIONCOUNTER_H
+
+#include <atomic>
+#include <cstdlib>
+#include <new>
+
+namespace LandingGear {
+
+  // Every operator new of the program, from any thread
+  inline std::atomic<unsigned long> allocations(0);
+
+}; // namespace LandingGear
+
+void* operator new(std::size_t size) {
+  LandingGear::allocations.fetch_add(1, std::memory_order_relaxed);
+
+  void* pointer = std::malloc(size ? size : 1);
+
+  if (pointer == nullptr) {
+    throw std::bad_alloc();
+  }
+
+  return pointer;
+}
+
+void* operator new[](std::size_t size) {
+  return operator new(size);
+}
+
+void operator delete(void* pointer) noexcept {
+  std::free(pointer);
+}
+
+void operator delete[](void* pointer) noexcept {
+  std::free(pointer);
+}
+
+void operator delete(void* pointer, std::size_t) noexcept {
+  std::free(pointer);
+}
+
+void operator delete[](void* pointer, std::size_t) noexcept {
+  std::free(pointer);
+}
+
+#endif
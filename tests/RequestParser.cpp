@@ -0,0 +1,53 @@
+#include "RequestParser.h"
+
+#include <iostream>
+#include <string>
+
+namespace LG = LandingGear;
+
+static int failures = 0;
+
+static void expect(bool condition, const char* what) {
+  if (!condition) {
+    std::cerr << "FAILED: " << what << std::endl;
+    failures++;
+  }
+}
+
+static LG::LGParseResult parse(LG::LGRequestParser& parser, const std::string& head) {
+  parser.reset();
+  return parser.parse(head.data(), head.size());
+}
+
+// Names a proxy could read differently than the server, eg. to smuggle a second request in the body
+static void testHeaderNames() {
+  LG::LGRequestParser parser;
+
+  expect(parse(parser, "GET / HTTP/1.1\r\nContent-Length: 5\r\n\r\n") == LG::LGParseResult::COMPLETE, "a plain header is accepted");
+  expect(parser.headers.size() == 1 && parser.headers[0].name == "Content-Length" && parser.headers[0].value == "5", "a plain header is parsed");
+
+  expect(parse(parser, "GET / HTTP/1.1\r\nX-Odd_Name.1~: value\r\n\r\n") == LG::LGParseResult::COMPLETE, "token characters are accepted in names");
+
+  struct { const char* head; const char* what; } invalid[] = {
+    {"GET / HTTP/1.1\r\nContent-Length : 5\r\n\r\n", "a space before the colon is rejected"},
+    {"GET / HTTP/1.1\r\nTransfer-Encoding\t: chunked\r\n\r\n", "a tab before the colon is rejected"},
+    {"GET / HTTP/1.1\r\nContent Length: 5\r\n\r\n", "a space inside a name is rejected"},
+    {"GET / HTTP/1.1\r\nX-\"Quoted\": 1\r\n\r\n", "a quote inside a name is rejected"},
+    {"GET / HTTP/1.1\r\n: empty\r\n\r\n", "an empty name is rejected"},
+  };
+
+  for (auto& line : invalid) {
+    expect(parse(parser, line.head) == LG::LGParseResult::ERROR && parser.errorCode == 400, line.what);
+  }
+}
+
+int main() {
+  testHeaderNames();
+
+  if (failures > 0) {
+    return 1;
+  }
+
+  std::cout << "RequestParser: passed" << std::endl;
+  return 0;
+}
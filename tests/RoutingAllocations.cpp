@@ -0,0 +1,88 @@
+#include "LandingGear.h"
+#include "AllocationCounter.h"
+
+#include <sys/socket.h>
+
+namespace LG = LandingGear;
+
+static int failures = 0;
+
+static void expect(bool condition, const char* what) {
+  if (!condition) {
+    std::cerr << "FAILED: " << what << std::endl;
+    failures++;
+  }
+}
+
+// The router alone, once its results have been sized by a first match
+static void testMatch(LG::LandingGear& app) {
+  LG::LGRouteMatches matches;
+  app.getRouter().match("/static/route", LG::LGMethod::HTTP_GET, matches);
+
+  unsigned long before = LG::allocations.load();
+
+  for (int i = 0; i < 1000; i++) {
+    app.getRouter().match("/static/route", LG::LGMethod::HTTP_GET, matches);
+  }
+
+  expect(LG::allocations.load() == before, "LGRouter::match allocates for a static route");
+  expect(matches.routeMatched && matches.matches.size() == 2, "LGRouter::match finds the mount and the route");
+}
+
+// Reading, parsing, matching and running the chain up to the handler, on a connection that served a few requests already
+static void testRequest(LG::LandingGear& app, unsigned long& atHandler) {
+  int sockets[2];
+
+  if (socketpair(AF_UNIX, SOCK_STREAM, 0, sockets)) {
+    expect(false, "socketpair");
+    return;
+  }
+
+  static const char request[] = "GET /static/route HTTP/1.1\r\nHost: localhost\r\nUser-Agent: test\r\nAccept: */*\r\n\r\n";
+  char response[4096];
+
+  LG::LGClientSocket socket = LG::LGClientSocket(sockets[0]);
+  socket.setNonBlocking(); // read like the event loop does, until nothing is left
+
+  LG::LGConnection connection = LG::LGConnection(socket, &app);
+
+  for (int i = 0; i < 100; i++) {
+    ::send(sockets[1], request, sizeof(request) - 1, 0);
+
+    unsigned long before = LG::allocations.load();
+    connection.onEvent(LG::LG_POLL_READ);
+
+    if (i >= 3) {
+      expect(atHandler == before, "routing a request to a static route allocates");
+    }
+
+    ssize_t received = ::recv(sockets[1], response, sizeof(response), 0);
+    expect(received > 0 && std::string_view(response, received).find("routed") != std::string_view::npos, "the handler answers");
+  }
+
+  ::close(sockets[1]);
+}
+
+int main() {
+  LG::LandingGear app = LG::LandingGear();
+  unsigned long atHandler = 0;
+
+  app.use("/static", [](LG::LGRequest&, LG::LGResponse&, LG::NextFunction next) {
+    next();
+  });
+
+  app.get("/static/route", [&atHandler](LG::LGRequest&, LG::LGResponse& res) {
+    atHandler = LG::allocations.load();
+    res.send("routed");
+  });
+
+  testMatch(app);
+  testRequest(app, atHandler);
+
+  if (failures > 0) {
+    return 1;
+  }
+
+  std::cout << "RoutingAllocations: passed" << std::endl;
+  return 0;
+}
@@ -0,0 +1,70 @@
+#include "WorkerPool.h"
+
+#include <iostream>
+
+namespace LG = LandingGear;
+
+static int failures = 0;
+
+static void expect(bool condition, const char* what) {
+  if (!condition) {
+    std::cerr << "FAILED: " << what << std::endl;
+    failures++;
+  }
+}
+
+// Jobs taken as soon as they are submitted must never be counted below zero
+static void testQueued() {
+  static const size_t SUBMITTERS = 4;
+  static const size_t JOBS = 100000;
+
+  LG::LGWorkerPool pool;
+  pool.start(4);
+
+  std::atomic<size_t> done(0);
+  std::atomic<bool> submitting(true);
+  size_t mostQueued = 0;
+
+  std::thread sampler([&]() {
+    while (submitting) {
+      mostQueued = std::max(mostQueued, pool.queued());
+    }
+  });
+
+  std::vector<std::thread> submitters;
+
+  for (size_t i = 0; i < SUBMITTERS; i++) {
+    submitters.push_back(std::thread([&]() {
+      for (size_t job = 0; job < JOBS; job++) {
+        pool.submit([&done]() { done++; });
+      }
+    }));
+  }
+
+  for (std::thread& submitter : submitters) {
+    submitter.join();
+  }
+
+  while (done < SUBMITTERS * JOBS) {
+    std::this_thread::yield();
+  }
+
+  submitting = false;
+  sampler.join();
+
+  expect(mostQueued <= SUBMITTERS * JOBS, "LGWorkerPool::queued counts more jobs than were submitted");
+  expect(pool.queued() == 0, "LGWorkerPool::queued counts jobs after all of them ran");
+
+  pool.stop();
+}
+
+int main() {
+  testQueued();
+
+  if (failures > 0) {
+    return 1;
+  }
+
+  std::cout << "WorkerPool: passed" << std::endl;
+  return 0;
+}